@@ -0,0 +1,105 @@
+#pragma once
+/**
+ * @brief 基准小工具 (无依赖): 计时、统计内存申请、按行输出 ns/op 与 allocs/op
+ *
+ * 替换了全局 operator new 来统计申请次数, 每个基准程序只能包含一次.
+ * 用法:
+ *     bench::Runner runner;
+ *     runner.run("name", n, [&](std::size_t n) { for (...) ...; });
+ * 每项先预热一遍, 再跑若干遍取最快的一遍 (内存申请次数取同一遍的).
+ */
+#ifndef _HX_BENCH_H_
+#define _HX_BENCH_H_
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+
+#include "HX/FrameAllocator.hpp"
+
+namespace bench {
+
+inline std::uint64_t g_allocCount = 0;
+
+/**
+ * @brief 阻止编译器把结果优化掉
+ */
+template <class T>
+inline void doNotOptimize(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief 一项基准的结果 (均为每次操作的平均值)
+ */
+struct Result {
+    double nsPerOp;
+    double allocsPerOp; // 全局 operator new 的调用次数
+    double framesPerOp; // FrameAllocator 分配的协程帧数 (命中空闲链表的不算进上一项)
+};
+
+class Runner {
+public:
+    /**
+     * @param repeats 每项跑几遍取最快的
+     */
+    explicit Runner(int repeats = 5) : _repeats(repeats > 0 ? repeats : 1) {
+        std::printf("%-40s %12s %12s %12s\n", "benchmark", "ns/op", "allocs/op", "frames/op");
+    }
+
+    /**
+     * @param body body(n) 执行 n 次被测操作
+     */
+    template <class F>
+    Result run(char const *name, std::size_t n, F &&body) {
+        n = n ? n : 1;
+        body(n); // 预热: 填满空闲链表与缓存
+        Result best {};
+        for (int i = 0; i < _repeats; ++i) {
+            auto frames = framesAllocated();
+            auto allocs = g_allocCount;
+            auto t0 = std::chrono::steady_clock::now();
+            body(n);
+            auto t1 = std::chrono::steady_clock::now();
+            Result res {
+                (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (double)n,
+                (double)(g_allocCount - allocs) / (double)n,
+                (double)(framesAllocated() - frames) / (double)n,
+            };
+            if (i == 0 || res.nsPerOp < best.nsPerOp) {
+                best = res;
+            }
+        }
+        std::printf("%-40s %12.2f %12.3f %12.3f\n", name, best.nsPerOp, best.allocsPerOp, best.framesPerOp);
+        return best;
+    }
+
+private:
+    static std::uint64_t framesAllocated() noexcept {
+        auto const &stats = HX::FrameAllocator::stats();
+        return stats.hits + stats.misses + stats.oversize;
+    }
+
+    int _repeats;
+};
+
+} // namespace bench
+
+void *operator new(std::size_t size) {
+    ++bench::g_allocCount;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#endif // !_HX_BENCH_H_
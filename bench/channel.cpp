@@ -0,0 +1,131 @@
+/**
+ * @brief HX::Channel 基准: SPSC / MPSC / MPMC 吞吐, 以及跨线程乒乓的往返延迟
+ *
+ * 吞吐: 生产者与消费者各占一个反应堆 (HX::ReactorPool), 每个生产者发送固定条数,
+ *       全部收完后计时结束; 容量小于总条数, 满/空时会走挂起 + eventfd 唤醒的慢路径.
+ * 延迟: 两个反应堆之间用两条容量为 2 的通道乒乓, 每次往返都要跨线程唤醒一次对方.
+ * 用法: channel [每个生产者的条数] [乒乓次数]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <vector>
+
+#include "HX/Channel.hpp"
+#include "HX/ReactorPool.hpp"
+
+using namespace std::chrono;
+
+using Queue = HX::Channel<std::uint64_t, 1024>;
+
+static HX::Task<void> produce(Queue &ch, std::uint64_t n, std::atomic<std::size_t> &left, std::latch &done) {
+    for (std::uint64_t i = 1; i <= n; ++i) {
+        co_await ch.send(i);
+    }
+    if (left.fetch_sub(1) == 1) { // 最后一个生产者负责关闭
+        ch.close();
+    }
+    done.count_down();
+}
+
+static HX::Task<void> consume(Queue &ch, std::atomic<std::uint64_t> &sum, std::latch &done) {
+    std::uint64_t local = 0;
+    while (true) {
+        auto value = co_await ch.recv();
+        if (!value) {
+            break;
+        }
+        local += *value;
+    }
+    sum += local;
+    done.count_down();
+}
+
+/**
+ * @return 每秒消息数
+ */
+static double runThroughput(std::size_t producers, std::size_t consumers, std::uint64_t n) {
+    HX::ReactorPool pool(producers + consumers);
+    Queue ch;
+    std::atomic<std::size_t> left = producers;
+    std::atomic<std::uint64_t> sum = 0;
+    std::latch done((std::ptrdiff_t)(producers + consumers));
+    auto t0 = steady_clock::now();
+    for (std::size_t i = 0; i < consumers; ++i) {
+        pool.spawn(i, consume(ch, sum, done));
+    }
+    for (std::size_t i = 0; i < producers; ++i) {
+        pool.spawn(consumers + i, produce(ch, n, left, done));
+    }
+    done.wait();
+    double seconds = duration<double>(steady_clock::now() - t0).count();
+    if (sum != producers * n * (n + 1) / 2) {
+        std::fprintf(stderr, "channel: sum mismatch\n");
+        std::exit(1);
+    }
+    return (double)(producers * n) / seconds;
+}
+
+using PingQueue = HX::Channel<std::uint64_t, 2>;
+
+static HX::Task<void> ponger(PingQueue &ping, PingQueue &pong, std::latch &done) {
+    while (true) {
+        auto value = co_await ping.recv();
+        if (!value) {
+            break;
+        }
+        co_await pong.send(*value);
+    }
+    done.count_down();
+}
+
+static HX::Task<void> pinger(PingQueue &ping, PingQueue &pong, std::vector<double> &rtts, std::latch &done) {
+    for (std::size_t i = 0; i < rtts.size(); ++i) {
+        auto t0 = steady_clock::now();
+        co_await ping.send(i);
+        [[maybe_unused]] auto value = co_await pong.recv();
+        rtts[i] = (double)duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+    }
+    ping.close();
+    done.count_down();
+}
+
+static void runLatency(std::size_t rounds) {
+    HX::ReactorPool pool(2);
+    PingQueue ping, pong;
+    std::vector<double> rtts(rounds);
+    std::latch done(2);
+    pool.spawn(0, ponger(ping, pong, done));
+    pool.spawn(1, pinger(ping, pong, rtts, done));
+    done.wait();
+    std::sort(rtts.begin(), rtts.end());
+    auto at = [&](double q) {
+        return rtts[std::min(rtts.size() - 1, (std::size_t)(q * (double)rtts.size()))] / 1000;
+    };
+    std::printf("%-6s %10s %10s %10s\n", "ping", "p50 us", "p99 us", "p999 us");
+    std::printf("%-6s %10.2f %10.2f %10.2f\n", "rtt", at(0.50), at(0.99), at(0.999));
+}
+
+int main(int argc, char **argv) {
+    std::uint64_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    std::size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100'000;
+    n = n ? n : 1;
+    rounds = rounds ? rounds : 1;
+
+    struct Shape {
+        const char *name;
+        std::size_t producers;
+        std::size_t consumers;
+    };
+    std::printf("%-6s %9s %9s %14s\n", "shape", "producers", "consumers", "msgs/s");
+    for (auto shape : {Shape {"SPSC", 1, 1}, Shape {"MPSC", 3, 1}, Shape {"MPMC", 3, 3}}) {
+        double rate = runThroughput(shape.producers, shape.consumers, n);
+        std::printf("%-6s %9zu %9zu %14.0f\n", shape.name, shape.producers, shape.consumers, rate);
+    }
+    std::printf("\n");
+    runLatency(rounds);
+    return 0;
+}
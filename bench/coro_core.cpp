@@ -0,0 +1,164 @@
+/**
+ * @brief 协程核心的微基准: 用数字盯住 Task / 对称转移 / Uninitialized / TimerLoop 的开销
+ *
+ *  - Task 创建+销毁 (不启动), 创建+co_await+销毁;
+ *  - 深度 1 ~ 10000 的 co_await 链 (每次操作是整条链, 另给出每层的开销);
+ *  - RepeatAwaiter (挂起后转回自己) 与 PreviousAwaiter (两个协程之间来回转移);
+ *  - Uninitialized 的 putVal + moveVal;
+ *  - TimerLoop 挂载/触发计时器, 以及经过 AsyncLoop 的 sleep_for(0) 往返.
+ * 每行输出 ns/op、全局 operator new 次数/op、协程帧数/op (帧来自 FrameAllocator 时不申请内存).
+ * 用法: coro_core [每项的操作次数]
+ */
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+
+#include "Bench.hpp"
+#include "HX/AsyncLoop.hpp"
+#include "HX/Task.hpp"
+#include "HX/TimerLoop.hpp"
+#include "HX/Uninitialized.hpp"
+
+using namespace std::chrono;
+
+static HX::Task<int> leaf(int x) {
+    co_return x;
+}
+
+static HX::Task<int> chain(int depth) {
+    if (depth <= 1) {
+        co_return 1;
+    }
+    int res = co_await chain(depth - 1);
+    co_return res + 1;
+}
+
+/**
+ * @brief 在当前线程的循环上跑完 task
+ */
+static void drive(HX::Task<void> task) {
+    HX::AsyncLoop loop;
+    HX::run_task(loop, task);
+}
+
+static HX::Task<void> awaitLeaves(std::size_t n) {
+    int sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += co_await leaf((int)i);
+    }
+    bench::doNotOptimize(sum);
+}
+
+static HX::Task<void> awaitChains(std::size_t n, int depth) {
+    for (std::size_t i = 0; i < n; ++i) {
+        int res = co_await chain(depth);
+        bench::doNotOptimize(res);
+    }
+}
+
+static HX::Task<void> repeat(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        co_await HX::RepeatAwaiter();
+    }
+}
+
+/**
+ * @brief 与 pong 来回转移: 每次 co_await PreviousAwaiter 切到对方, 对方再切回来
+ */
+static HX::Task<void> ping(std::size_t n, std::coroutine_handle<> &peer) {
+    for (std::size_t i = 0; i < n; ++i) {
+        co_await HX::PreviousAwaiter(peer);
+    }
+}
+
+static HX::Task<void> pong(std::coroutine_handle<> &peer) {
+    while (true) { // 由 ping 结束后随 Task 一起销毁
+        co_await HX::PreviousAwaiter(peer);
+    }
+}
+
+static HX::Task<void> sleepZero(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        co_await HX::TimerLoop::sleep_for(nanoseconds(0));
+    }
+}
+
+template <class T>
+static void putMove(std::size_t n, T const &value) {
+    HX::Uninitialized<T> slot;
+    for (std::size_t i = 0; i < n; ++i) {
+        slot.putVal(value);
+        bench::doNotOptimize(slot.moveVal());
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    n = n ? n : 1;
+    bench::Runner runner;
+
+    runner.run("Task create+destroy", n, [](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            auto task = leaf((int)i);
+            bench::doNotOptimize(task);
+        }
+    });
+    runner.run("Task create+await+destroy", n, [](std::size_t n) {
+        drive(awaitLeaves(n));
+    });
+
+    for (int depth : {1, 10, 100, 1000, 10000}) {
+        std::size_t chains = n / (std::size_t)depth;
+        chains = chains ? chains : 1;
+        char name[64];
+        std::snprintf(name, sizeof(name), "co_await chain depth %d", depth);
+        auto res = runner.run(name, chains, [depth](std::size_t n) {
+            drive(awaitChains(n, depth));
+        });
+        std::snprintf(name, sizeof(name), "  per level");
+        std::printf("%-40s %12.2f %12.3f %12.3f\n", name,
+            res.nsPerOp / depth, res.allocsPerOp / depth, res.framesPerOp / depth);
+    }
+
+    runner.run("RepeatAwaiter transfer", n, [](std::size_t n) {
+        drive(repeat(n));
+    });
+    runner.run("PreviousAwaiter transfer (round trip)", n, [](std::size_t n) {
+        std::coroutine_handle<> pingHandle, pongHandle;
+        auto pongTask = pong(pingHandle);
+        auto pingTask = ping(n, pongHandle);
+        pingHandle = pingTask;
+        pongHandle = pongTask;
+        drive(std::move(pingTask));
+    });
+
+    runner.run("Uninitialized<int> put+move", n, [](std::size_t n) {
+        putMove(n, 42);
+    });
+    runner.run("Uninitialized<std::string> put+move", n, [](std::size_t n) {
+        putMove(n, std::string("short string"));
+    });
+
+    // 节点预先放好 (不可移动, 用 deque 原地构造), 模拟 SleepAwaiter 嵌在协程帧里的情形
+    std::deque<HX::TimerLoop::TimerNode> nodes;
+    auto past = system_clock::now() - seconds(1);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto &node = nodes.emplace_back(past - nanoseconds(i * 7919 % 1000003));
+        node._coroutine = std::noop_coroutine();
+    }
+    runner.run("TimerLoop addTimer+fire", n, [&nodes](std::size_t) {
+        auto &loop = HX::TimerLoop::getLoop();
+        for (auto &node : nodes) {
+            loop.addTimer(node);
+        }
+        loop.run(); // 全部已到期, 一次触发完
+    });
+    // 每次都要进内核 (timerfd_settime + epoll_wait), 少跑一些
+    runner.run("TimerLoop sleep_for(0) via AsyncLoop", n / 100, [](std::size_t n) {
+        drive(sleepZero(n));
+    });
+    return 0;
+}
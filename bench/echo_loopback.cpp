@@ -0,0 +1,152 @@
+/**
+ * @brief 本机回环的端到端基准 (不需要外网): 回显服务端 + 压测客户端, 都跑在 HX 的循环上
+ *
+ * 服务端: 单个反应堆 (HX::ReactorPool) 监听 127.0.0.1, 每条连接一个回显协程;
+ * 客户端: 另一个线程上的 AsyncLoop, 每条连接一个协程, 发一条消息、收齐回显再发下一条.
+ * 扫描连接数 x 消息大小, 每组跑固定时长, 输出 请求/s、MB/s (单向负载) 与往返延迟的 p50/p99/p999.
+ * 每次修改反应堆都拿它做基线.
+ * 用法: echo_loopback [每组秒数] [--csv]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/AsyncFile.hpp"
+#include "HX/ReactorPool.hpp"
+#include "HX/WhenAll.hpp"
+
+using namespace std::chrono;
+
+static HX::Task<void> echo(HX::AsyncFile file) {
+    std::vector<char> buf(64 * 1024);
+    while (true) {
+        ssize_t n = co_await file.readFile(buf);
+        if (n <= 0) {
+            co_return;
+        }
+        co_await file.writeAll({buf.data(), (std::size_t)n});
+    }
+}
+
+/**
+ * @brief 连上本机端口 (同 createTcpClientByIpV4, 但回环上直接阻塞 connect, 不打印进度)
+ */
+static HX::AsyncFile connectTo(int port) {
+    int fd = HX::checkError(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP));
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+    addr.sin_port = htons(port);
+    HX::checkError(::connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    return HX::AsyncFile(fd); // 之后转为非阻塞, 挂到当前线程的循环上
+}
+
+/**
+ * @brief 一条连接上的乒乓, 直到 deadline; 每次往返的耗时 (纳秒) 追加到 rtts
+ */
+static HX::Task<void> client(
+    HX::AsyncFile file,
+    std::size_t size,
+    steady_clock::time_point deadline,
+    std::vector<std::int64_t> &rtts
+) {
+    std::vector<char> msg(size, 'x');
+    std::vector<char> buf(size);
+    while (steady_clock::now() < deadline) {
+        auto t0 = steady_clock::now();
+        co_await file.writeAll({msg.data(), size});
+        for (std::size_t got = 0; got < size; ) {
+            ssize_t len = co_await file.readFile({buf.data() + got, size - got});
+            if (len <= 0) {
+                co_return;
+            }
+            got += (std::size_t)len;
+        }
+        rtts.push_back(duration_cast<nanoseconds>(steady_clock::now() - t0).count());
+    }
+}
+
+static HX::Task<void> runClients(int port, std::size_t conns, std::size_t size,
+                                 double seconds, std::vector<std::int64_t> &rtts) {
+    std::vector<std::vector<std::int64_t>> perConn(conns);
+    std::vector<HX::Task<void>> tasks;
+    auto deadline = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double>(seconds));
+    for (std::size_t i = 0; i < conns; ++i) {
+        tasks.push_back(client(connectTo(port), size, deadline, perConn[i]));
+    }
+    co_await HX::when_all(std::move(tasks));
+    for (auto &part : perConn) {
+        rtts.insert(rtts.end(), part.begin(), part.end());
+    }
+}
+
+struct Row {
+    double reqPerSec;
+    double mbPerSec;
+    double p50Us;
+    double p99Us;
+    double p999Us;
+};
+
+static Row runRound(int port, std::size_t conns, std::size_t size, double seconds) {
+    std::vector<std::int64_t> rtts;
+    {
+        HX::AsyncLoop loop;
+        HX::run_task(loop, runClients(port, conns, size, seconds, rtts));
+    }
+    std::sort(rtts.begin(), rtts.end());
+    auto at = [&](double q) {
+        if (rtts.empty()) {
+            return 0.0;
+        }
+        return (double)rtts[std::min(rtts.size() - 1, (std::size_t)(q * (double)rtts.size()))] / 1000;
+    };
+    double reqPerSec = (double)rtts.size() / seconds;
+    return {reqPerSec, reqPerSec * (double)size / 1e6, at(0.50), at(0.99), at(0.999)};
+}
+
+int main(int argc, char **argv) {
+    double seconds = 1.0;
+    bool csv = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--csv") {
+            csv = true;
+        } else {
+            seconds = std::strtod(argv[i], nullptr);
+        }
+    }
+    seconds = seconds > 0 ? seconds : 1.0;
+
+    int port = 19100;
+    HX::ReactorPool server(1);
+    server.listen("127.0.0.1", port, echo);
+
+    if (csv) {
+        std::printf("conns,size,req_per_s,mb_per_s,p50_us,p99_us,p999_us\n");
+    } else {
+        std::printf("%6s %7s %12s %10s %10s %10s %10s\n",
+            "conns", "size", "req/s", "MB/s", "p50 us", "p99 us", "p999 us");
+    }
+    for (std::size_t conns : {1, 16, 64, 256}) {
+        for (std::size_t size : {64, 1024, 16 * 1024}) {
+            auto row = runRound(port, conns, size, seconds);
+            std::printf(csv ? "%zu,%zu,%.0f,%.2f,%.2f,%.2f,%.2f\n"
+                            : "%6zu %7zu %12.0f %10.2f %10.2f %10.2f %10.2f\n",
+                conns, size, row.reqPerSec, row.mbPerSec, row.p50Us, row.p99Us, row.p999Us);
+            std::fflush(stdout);
+        }
+    }
+    return 0;
+}
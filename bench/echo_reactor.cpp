@@ -0,0 +1,118 @@
+/**
+ * @brief 多反应堆回显基准: 反应堆个数从 1 翻倍到核数, 看吞吐是否随核数线性增长
+ *
+ * 服务端: HX::ReactorPool, 每个反应堆一个 SO_REUSEPORT 监听 socket;
+ * 客户端: 与反应堆同样多的线程, 每个线程若干条阻塞连接轮流乒乓 (64 字节).
+ * 用法: echo_reactor [最大反应堆数] [每个客户端线程的连接数] [每轮秒数]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HX/ReactorPool.hpp"
+
+using namespace std::chrono;
+
+static HX::Task<void> echo(HX::AsyncFile file) {
+    std::vector<char> buf(4096);
+    while (true) {
+        ssize_t n = co_await file.readFile(buf);
+        if (n <= 0) {
+            co_return;
+        }
+        co_await file.writeFile({buf.data(), (std::size_t)n});
+    }
+}
+
+static int connectTo(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+    addr.sin_port = htons(port);
+    if (::connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        std::perror("connect");
+        std::exit(1);
+    }
+    return fd;
+}
+
+/**
+ * @return 每秒往返次数
+ */
+static double runRound(std::size_t reactors, std::size_t conns, double seconds, int port) {
+    HX::ReactorPool pool(reactors);
+    pool.listen("127.0.0.1", port, echo);
+
+    std::atomic<bool> stop = false;
+    std::atomic<std::uint64_t> total = 0;
+    std::vector<std::thread> clients;
+    for (std::size_t t = 0; t < reactors; ++t) {
+        clients.emplace_back([&] {
+            std::vector<int> fds;
+            for (std::size_t i = 0; i < conns; ++i) {
+                fds.push_back(connectTo(port));
+            }
+            char msg[64] = {};
+            std::uint64_t count = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int fd : fds) { // 先全部发出, 再全部收回, 保持每条连接上一个请求
+                    [[maybe_unused]] auto _ = ::write(fd, msg, sizeof(msg));
+                }
+                for (int fd : fds) {
+                    std::size_t got = 0;
+                    while (got < sizeof(msg)) {
+                        ssize_t n = ::read(fd, msg + got, sizeof(msg) - got);
+                        if (n <= 0) {
+                            return;
+                        }
+                        got += (std::size_t)n;
+                    }
+                }
+                count += fds.size();
+            }
+            total += count;
+            for (int fd : fds) {
+                ::close(fd);
+            }
+        });
+    }
+    std::this_thread::sleep_for(duration<double>(seconds));
+    stop = true;
+    for (auto &client : clients) {
+        client.join();
+    }
+    return (double)total.load() / seconds;
+}
+
+int main(int argc, char **argv) {
+    std::size_t maxReactors = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                       : std::thread::hardware_concurrency();
+    std::size_t conns = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    double seconds = argc > 3 ? std::strtod(argv[3], nullptr) : 2.0;
+    maxReactors = maxReactors ? maxReactors : 1;
+
+    std::printf("%-9s %14s %10s\n", "reactors", "round trips/s", "speedup");
+    double base = 0;
+    int port = 19000;
+    for (std::size_t n = 1; ; n *= 2) {
+        n = n > maxReactors ? maxReactors : n;
+        double rate = runRound(n, conns, seconds, port++);
+        base = base ? base : rate;
+        std::printf("%-9zu %14.0f %9.2fx\n", n, rate, rate / base);
+        if (n == maxReactors) {
+            break;
+        }
+    }
+    return 0;
+}
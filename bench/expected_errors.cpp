@@ -0,0 +1,100 @@
+/**
+ * @brief 错误密集负载: 抛异常的 Task<T> vs 以 std::expected 返回错误的 ExpectedTask<T>
+ *
+ * 叶子协程按给定比例失败 (模拟 EAGAIN/ECONNRESET/超时), 错误穿过 depth 层协程回到驱动者:
+ *  - throw:    叶子抛 std::system_error, 每层 co_await 重新抛出, 驱动者 catch;
+ *  - expected: 叶子 co_return std::unexpected, 每层 co_await try_await(...) 直接把错误交给上层.
+ * 报告每次调用 (整条链) 的耗时.
+ * 用法: expected_errors [每组调用次数]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+
+#include "HX/Task.hpp"
+#include "HX/Expected.hpp"
+#include "HX/AsyncLoop.hpp"
+
+using namespace std::chrono;
+
+static bool shouldFail(long i, int percent) noexcept {
+    return i % 100 < percent;
+}
+
+HX::Task<long> throwLeaf(long i, int percent) {
+    if (shouldFail(i, percent)) {
+        throw std::system_error(std::make_error_code(std::errc::resource_unavailable_try_again));
+    }
+    co_return i;
+}
+
+HX::Task<long> throwChain(long i, int percent, int depth) {
+    if (depth == 0) {
+        co_return co_await throwLeaf(i, percent);
+    }
+    co_return co_await throwChain(i, percent, depth - 1) + 1;
+}
+
+HX::Task<long> throwDriver(long n, int percent, int depth) {
+    long sum = 0;
+    for (long i = 0; i < n; ++i) {
+        try {
+            sum += co_await throwChain(i, percent, depth);
+        } catch (std::system_error const &) {
+            --sum;
+        }
+    }
+    co_return sum;
+}
+
+HX::ExpectedTask<long> expectedLeaf(long i, int percent) {
+    if (shouldFail(i, percent)) {
+        co_return std::unexpected(std::make_error_code(std::errc::resource_unavailable_try_again));
+    }
+    co_return i;
+}
+
+HX::ExpectedTask<long> expectedChain(long i, int percent, int depth) {
+    if (depth == 0) {
+        co_return co_await HX::try_await(expectedLeaf(i, percent));
+    }
+    co_return co_await HX::try_await(expectedChain(i, percent, depth - 1)) + 1;
+}
+
+HX::Task<long> expectedDriver(long n, int percent, int depth) {
+    long sum = 0;
+    for (long i = 0; i < n; ++i) {
+        auto res = co_await expectedChain(i, percent, depth);
+        sum += res ? *res : -1;
+    }
+    co_return sum;
+}
+
+template <class Driver>
+static double nsPerCall(Driver driver, long n, int percent, int depth, long &check) {
+    HX::AsyncLoop loop;
+    auto t0 = steady_clock::now();
+    check = HX::run_task(loop, driver(n, percent, depth));
+    auto t1 = steady_clock::now();
+    return (double)duration_cast<nanoseconds>(t1 - t0).count() / (double)n;
+}
+
+int main(int argc, char **argv) {
+    long n = argc > 1 ? std::atol(argv[1]) : 200000;
+    std::printf("%-6s %-8s %14s %14s %8s\n", "depth", "errors", "throw ns/op", "expected ns/op", "ratio");
+    for (int depth : {0, 4, 16}) {
+        for (int percent : {0, 10, 50, 100}) {
+            long a = 0, b = 0;
+            double throwNs = nsPerCall(throwDriver, n, percent, depth, a);
+            double expectedNs = nsPerCall(expectedDriver, n, percent, depth, b);
+            if (a != b) {
+                std::printf("结果不一致: %ld != %ld\n", a, b);
+                return 1;
+            }
+            std::printf("%-6d %6d%% %14.1f %14.1f %7.1fx\n",
+                        depth, percent, throwNs, expectedNs, throwNs / expectedNs);
+        }
+    }
+    return 0;
+}
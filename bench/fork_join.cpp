@@ -0,0 +1,146 @@
+/**
+ * @brief 工作窃取线程池的 fork/join 扩展性基准: 并行 fib 与并行归约
+ *
+ * 工作线程数从 1 翻倍到核数, 报告耗时与相对 1 线程的加速比.
+ * 用法: fork_join [最大线程数] [fib 的 n] [归约的元素个数]
+ */
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "HX/StealingExecutor.hpp"
+
+using namespace std::chrono;
+
+/**
+ * @brief 派生一个子任务到池里 (可被窃取), 之后 co_await 它来汇合
+ */
+template <class T>
+class Fork {
+    struct State {
+        std::optional<T> _res;
+        std::coroutine_handle<> _parent;
+        std::atomic<bool> _done = false; // 先到的一方置位, 后到的一方负责继续父协程
+    };
+
+    static HX::DetachedTask run(HX::Task<T> task, State &state) {
+        state._res = co_await task;
+        if (state._done.exchange(true, std::memory_order_acq_rel)) {
+            state._parent.resume(); // 父协程已在等
+        }
+    }
+
+public:
+    Fork(HX::StealingExecutor &executor, HX::Task<T> task) {
+        executor.post(run(std::move(task), _state)._coroutine);
+    }
+
+    Fork &operator=(Fork &&) = delete;
+
+    bool await_ready() const noexcept {
+        return _state._done.load(std::memory_order_acquire);
+    }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) noexcept {
+        _state._parent = coroutine;
+        return !_state._done.exchange(true, std::memory_order_acq_rel); // 子任务已完成则不挂起
+    }
+
+    T await_resume() {
+        return std::move(*_state._res);
+    }
+
+private:
+    State _state;
+};
+
+static long serialFib(int n) {
+    return n < 2 ? n : serialFib(n - 1) + serialFib(n - 2);
+}
+
+static HX::Task<long> fib(HX::StealingExecutor &executor, int n) {
+    if (n < 20) { // 粒度太小就串行, 否则调度开销压过计算
+        co_return serialFib(n);
+    }
+    Fork<long> left(executor, fib(executor, n - 1));
+    long right = co_await fib(executor, n - 2);
+    co_return co_await left + right;
+}
+
+static HX::Task<double> reduce(HX::StealingExecutor &executor, double const *data, std::size_t n) {
+    if (n <= (1u << 14)) {
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += std::sqrt(data[i]);
+        }
+        co_return sum;
+    }
+    Fork<double> left(executor, reduce(executor, data, n / 2));
+    double right = co_await reduce(executor, data + n / 2, n - n / 2);
+    co_return co_await left + right;
+}
+
+template <class T>
+static HX::Task<void> runInPool(HX::StealingExecutor &executor, HX::Task<T> task, std::promise<T> res) {
+    co_await executor.schedule();
+    res.set_value(co_await task);
+}
+
+/**
+ * @brief 在池中运行 task, 阻塞等它完成
+ */
+template <class T>
+static T blockOn(HX::StealingExecutor &executor, HX::Task<T> task) {
+    std::promise<T> res;
+    auto future = res.get_future();
+    HX::detach(runInPool(executor, std::move(task), std::move(res)))._coroutine.resume();
+    return future.get();
+}
+
+template <class F>
+static double timeIt(F &&func) {
+    auto t0 = steady_clock::now();
+    func();
+    return duration<double, std::milli>(steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    std::size_t maxWorkers = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                      : std::thread::hardware_concurrency();
+    int fibN = argc > 2 ? std::atoi(argv[2]) : 36;
+    std::size_t count = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : (1u << 24);
+    maxWorkers = maxWorkers ? maxWorkers : 1;
+
+    std::vector<double> data(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        data[i] = (double)(i % 1000);
+    }
+
+    double fibBase = 0, reduceBase = 0;
+    std::printf("%-8s %12s %8s %14s %8s\n", "workers", "fib ms", "speedup", "reduce ms", "speedup");
+    for (std::size_t n = 1; ; n *= 2) {
+        n = n > maxWorkers ? maxWorkers : n;
+        HX::StealingExecutor executor(n);
+        long fibRes = 0;
+        double sum = 0;
+        double fibMs = timeIt([&] { fibRes = blockOn(executor, fib(executor, fibN)); });
+        double reduceMs = timeIt([&] { sum = blockOn(executor, reduce(executor, data.data(), count)); });
+        if (fibRes != serialFib(fibN)) {
+            std::abort();
+        }
+        fibBase = fibBase ? fibBase : fibMs;
+        reduceBase = reduceBase ? reduceBase : reduceMs;
+        std::printf("%-8zu %12.1f %7.2fx %14.1f %7.2fx  (sum %.0f)\n",
+                    n, fibMs, fibBase / fibMs, reduceMs, reduceBase / reduceMs, sum);
+        if (n == maxWorkers) {
+            break;
+        }
+    }
+    return 0;
+}
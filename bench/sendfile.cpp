@@ -0,0 +1,167 @@
+/**
+ * @brief 大文件下发基准 (本机回环): 零拷贝的 HX::sendFile / HX::spliceForward / HX::ZeroCopySender
+ *        对比经过用户态的 read + write
+ *
+ * 服务端 (单个反应堆) 同时监听五个端口, 连接一建立就把整份文件发出去然后关闭:
+ *  - read+write:   pread 到 64 KiB 缓冲区再 writeAll;
+ *  - sendFile:     sendfile, 数据不经过用户态;
+ *  - proxy copy:   代理, 连到 sendFile 端口, 收到什么用 readFile + writeAll 转发什么;
+ *  - proxy splice: 代理, 同上但用 spliceForward (socket -> 管道 -> socket);
+ *  - mmap+zerocopy: 文件 mmap 进来, 用 MSG_ZEROCOPY 整块发送.
+ *    回环上内核会退回拷贝 (SO_EE_CODE_ZEROCOPY_COPIED), 这一行只反映锁页与读通知的额外开销.
+ * 客户端在主线程上阻塞地收到 EOF, 每种方式跑若干遍, 输出 MB/s.
+ * 用法: sendfile [文件 MiB 数] [遍数]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <vector>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HX/AsyncFile.hpp"
+#include "HX/ReactorPool.hpp"
+#include "HX/SendFile.hpp"
+#include "HX/ZeroCopy.hpp"
+
+using namespace std::chrono;
+
+static constexpr int kPort = 19200;
+
+/**
+ * @brief 阻塞地连上本机端口
+ */
+static int connectTo(int port) {
+    int fd = HX::checkError(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP));
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+    addr.sin_port = htons(port);
+    HX::checkError(::connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    return fd;
+}
+
+static HX::Task<void> serveCopy(HX::AsyncFile sock, int fileFd, std::size_t size) {
+    std::vector<char> buf(64 * 1024);
+    for (std::size_t done = 0; done < size; ) {
+        ssize_t n = HX::checkError(::pread(fileFd, buf.data(), buf.size(), (off_t)done));
+        if (n == 0) {
+            break;
+        }
+        co_await sock.writeAll({buf.data(), (std::size_t)n});
+        done += (std::size_t)n;
+    }
+}
+
+static HX::Task<void> serveSendFile(HX::AsyncFile sock, int fileFd, std::size_t size) {
+    co_await HX::sendFile(sock, fileFd, 0, size);
+}
+
+static HX::Task<void> serveZeroCopy(HX::AsyncFile sock, std::span<char const> blob) {
+    HX::ZeroCopySender sender(sock);
+    co_await sender.send(blob);
+}
+
+static HX::Task<void> proxyCopy(HX::AsyncFile client) {
+    HX::AsyncFile upstream(connectTo(kPort + 1));
+    std::vector<char> buf(64 * 1024);
+    while (true) {
+        ssize_t n = co_await upstream.readFile(buf);
+        if (n <= 0) {
+            co_return;
+        }
+        co_await client.writeAll({buf.data(), (std::size_t)n});
+    }
+}
+
+static HX::Task<void> proxySplice(HX::AsyncFile client) {
+    HX::AsyncFile upstream(connectTo(kPort + 1));
+    co_await HX::spliceForward(upstream, client);
+}
+
+/**
+ * @return 收完一份文件的 MB/s
+ */
+static double fetch(int port, std::size_t size) {
+    static std::vector<char> buf(256 * 1024);
+    int fd = connectTo(port);
+    std::size_t got = 0;
+    auto t0 = steady_clock::now();
+    while (true) {
+        ssize_t n = HX::checkError(::read(fd, buf.data(), buf.size()));
+        if (n == 0) {
+            break;
+        }
+        got += (std::size_t)n;
+    }
+    double seconds = duration<double>(steady_clock::now() - t0).count();
+    ::close(fd);
+    if (got != size) {
+        std::fprintf(stderr, "sendfile: got %zu of %zu bytes\n", got, size);
+        std::exit(1);
+    }
+    return (double)size / 1e6 / seconds;
+}
+
+int main(int argc, char **argv) {
+    std::size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    mib = mib ? mib : 1;
+    rounds = rounds > 0 ? rounds : 1;
+    std::size_t size = mib << 20;
+
+    // 匿名临时文件, 先整个写一遍让它进页缓存
+    FILE *tmp = std::tmpfile();
+    int fileFd = ::fileno(tmp);
+    std::vector<char> block(1 << 20);
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        block[i] = (char)(i * 131);
+    }
+    for (std::size_t i = 0; i < mib; ++i) {
+        HX::checkError(::write(fileFd, block.data(), block.size()));
+    }
+
+    HX::ReactorPool server(1);
+    server.listen("127.0.0.1", kPort, [fileFd, size](HX::AsyncFile sock) {
+        return serveCopy(std::move(sock), fileFd, size);
+    });
+    server.listen("127.0.0.1", kPort + 1, [fileFd, size](HX::AsyncFile sock) {
+        return serveSendFile(std::move(sock), fileFd, size);
+    });
+    server.listen("127.0.0.1", kPort + 2, proxyCopy);
+    server.listen("127.0.0.1", kPort + 3, proxySplice);
+    void *blob = ::mmap(nullptr, size, PROT_READ, MAP_SHARED | MAP_POPULATE, fileFd, 0);
+    if (blob == MAP_FAILED) {
+        HX::checkError(-1);
+    }
+    server.listen("127.0.0.1", kPort + 4, [blob, size](HX::AsyncFile sock) {
+        return serveZeroCopy(std::move(sock), {static_cast<char const *>(blob), size});
+    });
+
+    struct Mode {
+        const char *name;
+        int port;
+    };
+    std::printf("%-14s %10s %10s\n", "mode", "avg MB/s", "best MB/s");
+    for (auto mode : {Mode {"read+write", kPort}, Mode {"sendFile", kPort + 1},
+                      Mode {"proxy copy", kPort + 2}, Mode {"proxy splice", kPort + 3},
+                      Mode {"mmap+zerocopy", kPort + 4}}) {
+        fetch(mode.port, size); // 预热
+        double sum = 0, best = 0;
+        for (int i = 0; i < rounds; ++i) {
+            double rate = fetch(mode.port, size);
+            sum += rate;
+            best = std::max(best, rate);
+        }
+        std::printf("%-14s %10.0f %10.0f\n", mode.name, sum / rounds, best);
+    }
+    server.stop(); // 先停服务端, 再解除映射
+    ::munmap(blob, size);
+    std::fclose(tmp);
+    return 0;
+}
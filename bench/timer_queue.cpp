@@ -0,0 +1,200 @@
+/**
+ * @brief 计时器队列基准: std::multimap vs 侵入式 RbTree vs 分层时间轮
+ *
+ * 100 万个随机到期时间 (一分钟内, 毫秒粒度) 的计时器:
+ *  - fire:   全部挂上, 再按时间推进全部触发;
+ *  - cancel: 全部挂上, 取消其中 90% (空闲/请求超时的常见情形), 再触发剩下的.
+ * 并统计挂载阶段全局 operator new 的调用次数.
+ */
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "HX/TimingWheel.hpp"
+#include "rbtree.hpp"
+
+static std::size_t g_allocCount = 0;
+
+void *operator new(std::size_t size) {
+    ++g_allocCount;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace std::chrono;
+
+struct Result {
+    double armNs;       // 每个计时器的挂载耗时
+    double cancelNs;    // 每个被取消计时器的取消耗时
+    double fireNs;      // 每个计时器的触发耗时
+    std::size_t allocs; // 挂载阶段的内存申请次数
+};
+
+static void report(char const *name, Result const &res, std::size_t n) {
+    std::printf(
+        "%-14s arm: %7.2f ns/op  cancel: %7.2f ns/op  fire: %7.2f ns/op  allocs/arm: %.3f\n",
+        name, res.armNs, res.cancelNs, res.fireNs, (double)res.allocs / (double)n);
+}
+
+static double perOp(steady_clock::duration d, std::size_t n) {
+    return n ? (double)duration_cast<nanoseconds>(d).count() / (double)n : 0.0;
+}
+
+/**
+ * @param ticks 每个计时器的到期 tick (毫秒)
+ * @param cancel 每个计时器是否在触发前被取消
+ */
+static Result benchMultimap(std::vector<std::uint64_t> const &ticks, std::vector<bool> const &cancel) {
+    using Map = std::multimap<std::uint64_t, std::coroutine_handle<>>;
+    Map timers;
+    std::vector<Map::iterator> its(ticks.size());
+    std::size_t allocs = g_allocCount;
+    auto t0 = steady_clock::now();
+    for (std::size_t i = 0; i < ticks.size(); ++i) {
+        its[i] = timers.insert({ticks[i], std::noop_coroutine()});
+    }
+    auto t1 = steady_clock::now();
+    allocs = g_allocCount - allocs;
+    std::size_t cancelled = 0;
+    for (std::size_t i = 0; i < ticks.size(); ++i) {
+        if (cancel[i]) {
+            timers.erase(its[i]);
+            ++cancelled;
+        }
+    }
+    auto t2 = steady_clock::now();
+    std::size_t fired = 0;
+    while (!timers.empty()) {
+        auto it = timers.begin();
+        fired += (bool)it->second;
+        timers.erase(it);
+    }
+    auto t3 = steady_clock::now();
+    if (fired + cancelled != ticks.size())
+        std::abort();
+    return {perOp(t1 - t0, ticks.size()), perOp(t2 - t1, cancelled), perOp(t3 - t2, fired), allocs};
+}
+
+struct TreeNode;
+
+struct TreeNodeLess {
+    bool operator()(TreeNode const &lhs, TreeNode const &rhs) const noexcept;
+};
+
+struct TreeNode : RbTree<TreeNode, TreeNodeLess>::RbNode {
+    std::uint64_t _tick = 0;
+    std::coroutine_handle<> _coroutine {};
+};
+
+bool TreeNodeLess::operator()(TreeNode const &lhs, TreeNode const &rhs) const noexcept {
+    return lhs._tick < rhs._tick;
+}
+
+static Result benchRbTree(std::vector<std::uint64_t> const &ticks, std::vector<bool> const &cancel) {
+    // 节点预先放好, 模拟 SleepAwaiter 嵌在协程帧里的情形
+    std::deque<TreeNode> nodes(ticks.size()); // 节点不可移动, 用 deque 原地构造
+    RbTree<TreeNode, TreeNodeLess> timers;
+    std::size_t allocs = g_allocCount;
+    auto t0 = steady_clock::now();
+    for (std::size_t i = 0; i < ticks.size(); ++i) {
+        nodes[i]._tick = ticks[i];
+        nodes[i]._coroutine = std::noop_coroutine();
+        timers.insert(nodes[i]);
+    }
+    auto t1 = steady_clock::now();
+    allocs = g_allocCount - allocs;
+    std::size_t cancelled = 0;
+    for (std::size_t i = 0; i < ticks.size(); ++i) {
+        if (cancel[i]) {
+            timers.erase(nodes[i]);
+            ++cancelled;
+        }
+    }
+    auto t2 = steady_clock::now();
+    std::size_t fired = 0;
+    while (!timers.empty()) {
+        auto &node = timers.front();
+        fired += (bool)node._coroutine;
+        timers.erase(node);
+    }
+    auto t3 = steady_clock::now();
+    if (fired + cancelled != ticks.size())
+        std::abort();
+    return {perOp(t1 - t0, ticks.size()), perOp(t2 - t1, cancelled), perOp(t3 - t2, fired), allocs};
+}
+
+struct WheelNode : HX::TimingWheel<WheelNode>::WheelNode {
+    std::coroutine_handle<> _coroutine {};
+};
+
+static Result benchWheel(std::vector<std::uint64_t> const &ticks, std::vector<bool> const &cancel) {
+    std::deque<WheelNode> nodes(ticks.size());
+    HX::TimingWheel<WheelNode> timers(0);
+    std::size_t allocs = g_allocCount;
+    auto t0 = steady_clock::now();
+    for (std::size_t i = 0; i < ticks.size(); ++i) {
+        nodes[i]._coroutine = std::noop_coroutine();
+        timers.insert(nodes[i], ticks[i]);
+    }
+    auto t1 = steady_clock::now();
+    allocs = g_allocCount - allocs;
+    std::size_t cancelled = 0;
+    for (std::size_t i = 0; i < ticks.size(); ++i) {
+        if (cancel[i]) {
+            timers.erase(nodes[i]);
+            ++cancelled;
+        }
+    }
+    auto t2 = steady_clock::now();
+    std::size_t fired = 0;
+    for (std::uint64_t now = 0; !timers.empty(); now += 1) { // 逐毫秒推进
+        timers.advance(now, [&](WheelNode &node) {
+            fired += (bool)node._coroutine;
+        });
+    }
+    auto t3 = steady_clock::now();
+    if (fired + cancelled != ticks.size())
+        std::abort();
+    return {perOp(t1 - t0, ticks.size()), perOp(t2 - t1, cancelled), perOp(t3 - t2, fired), allocs};
+}
+
+int main(int argc, char **argv) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::uint64_t> dist(1, 60'000);
+    std::vector<std::uint64_t> ticks(n);
+    for (auto &tick : ticks) {
+        tick = dist(rng);
+    }
+    std::vector<bool> none(n, false);
+    std::vector<bool> most(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        most[i] = rng() % 10 != 0;
+    }
+
+    std::printf("timers: %zu, all fire\n", n);
+    report("std::multimap", benchMultimap(ticks, none), n);
+    report("RbTree", benchRbTree(ticks, none), n);
+    report("TimingWheel", benchWheel(ticks, none), n);
+
+    std::printf("timers: %zu, 90%% cancelled before firing\n", n);
+    report("std::multimap", benchMultimap(ticks, most), n);
+    report("RbTree", benchRbTree(ticks, most), n);
+    report("TimingWheel", benchWheel(ticks, most), n);
+    return 0;
+}
@@ -0,0 +1,83 @@
+/**
+ * @brief io_uring 固定缓冲区基准: 同一对 socket 上, 普通 READ/WRITE 对比 READ_FIXED/WRITE_FIXED
+ *
+ * 本程序强制开启 HX_USE_IO_URING. 同一个循环上一个协程按块写、另一个协程按块读 (AF_UNIX socketpair),
+ * 先用普通缓冲区跑, 再把两块缓冲区 registerBuffers 之后跑同样的量; AsyncFile 自动识别已注册的缓冲区.
+ * 每行是每块 (一次写 + 一次读) 的耗时与对应的 MB/s.
+ * 用法: uring_fixed [块数] [块大小 KiB]
+ */
+#define HX_USE_IO_URING 1
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "Bench.hpp"
+#include "HX/AsyncLoop.hpp"
+#include "HX/AsyncFile.hpp"
+#include "HX/UringLoop.hpp"
+#include "HX/WhenAll.hpp"
+
+static HX::Task<void> writer(HX::AsyncFile &file, std::vector<char> &buf, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t done = 0; done < buf.size(); ) {
+            auto len = co_await file.tryWrite({buf.data() + done, buf.size() - done});
+            if (!len) {
+                throw std::system_error(len.error());
+            }
+            done += *len;
+        }
+    }
+}
+
+static HX::Task<void> reader(HX::AsyncFile &file, std::vector<char> &buf, std::size_t n) {
+    for (std::size_t left = n * buf.size(); left; ) {
+        auto len = co_await file.tryRead({buf.data(), std::min(left, buf.size())});
+        if (!len) {
+            throw std::system_error(len.error());
+        }
+        if (*len == 0) {
+            std::fprintf(stderr, "uring_fixed: unexpected EOF\n");
+            std::exit(1);
+        }
+        left -= *len;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000;
+    std::size_t kib = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+    n = n ? n : 1;
+    kib = kib ? kib : 1;
+    if (!HX::UringLoop::isEnabled()) {
+        std::printf("io_uring unavailable, nothing to measure\n");
+        return 0;
+    }
+
+    HX::AsyncLoop loop;
+    int fds[2];
+    HX::checkError(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds));
+    HX::AsyncFile out(fds[0]), in(fds[1]);
+    std::vector<char> sendBuf(kib * 1024, 'x'), recvBuf(kib * 1024);
+
+    auto run = [&](std::size_t n) {
+        HX::run_task(loop, HX::when_all(writer(out, sendBuf, n), reader(in, recvBuf, n)));
+    };
+    bench::Runner runner;
+    auto plain = runner.run("READ/WRITE", n, run);
+
+    struct ::iovec bufs[] {{sendBuf.data(), sendBuf.size()}, {recvBuf.data(), recvBuf.size()}};
+    if (!HX::UringLoop::get().registerBuffers(bufs)) {
+        std::printf("registerBuffers failed, skipping the fixed-buffer run\n");
+        return 0;
+    }
+    auto fixed = runner.run("READ_FIXED/WRITE_FIXED", n, run);
+    HX::UringLoop::get().unregisterBuffers();
+
+    double mb = (double)sendBuf.size() / 1e6;
+    std::printf("\n%-24s %10.0f MB/s\n%-24s %10.0f MB/s\n",
+        "READ/WRITE", mb / plain.nsPerOp * 1e9, "READ_FIXED/WRITE_FIXED", mb / fixed.nsPerOp * 1e9);
+    return 0;
+}
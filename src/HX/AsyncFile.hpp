@@ -0,0 +1,508 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 15:40:19
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_ASYNC_FILE_H_
+#define _HX_ASYNC_FILE_H_
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Task.hpp"
+#include "AsyncGenerator.hpp"
+#include "Expected.hpp"
+#include "EpollLoop.hpp"
+#include "UringLoop.hpp"
+#include "CheckError.hpp"
+
+namespace HX {
+
+class AsyncFile {
+protected:
+    static constexpr std::size_t kWritevBatch = 16; // writeAll 每次 writev 至多带几块 (<= IOV_MAX)
+
+    int _fd = -1;
+    int _fixedIndex = -1; // io_uring 注册文件表中的下标
+    std::unique_ptr<EpollFdState> _state; // epoll 注册状态 (只注册一次)
+public:
+    AsyncFile() : _fd(-1)
+    {}
+
+    /**
+     * @param nonBlocking fd 已经是非阻塞的 (如 accept4 带了 SOCK_NONBLOCK), 省掉两次 fcntl
+     */
+    explicit AsyncFile(int fd, bool nonBlocking = false) : _fd(fd) {
+        if (!nonBlocking) { // 设置非阻塞
+            int flags = ::fcntl(_fd, F_GETFL);
+            flags |= O_NONBLOCK;
+            ::fcntl(_fd, F_SETFL, flags);
+        }
+
+        if (UringLoop::isEnabled()) { // 走 io_uring 就不用挂 epoll 了
+            _fixedIndex = UringLoop::get().registerFile(_fd);
+            return;
+        }
+
+        _state = std::make_unique<EpollFdState>(_fd);
+    }
+
+    /**
+     * @brief 写一次 (可能只写了一部分), 错误以 std::error_code 返回, 不抛异常
+     * @return 写入的字节数
+     */
+    HX::ExpectedTask<std::size_t> tryWrite(std::string_view str) {
+        if (UringLoop::isEnabled()) {
+            int bufIndex = UringLoop::get().findFixedBuffer(str.data(), str.size());
+            int res;
+            while ((res = co_await (bufIndex >= 0 // 落在已注册的缓冲区里就用 WRITE_FIXED
+                    ? UringLoop::writeFixed(_fd, str, (std::uint16_t)bufIndex, _fixedIndex)
+                    : UringLoop::write(_fd, str, _fixedIndex))) == -EAGAIN
+            ) {
+                if ((res = co_await UringLoop::poll(_fd, POLLOUT, _fixedIndex)) < 0) {
+                    break; // 被取消
+                }
+            }
+            if (res < 0) {
+                co_return std::unexpected(std::error_code(-res, std::system_category()));
+            }
+            co_return static_cast<std::size_t>(res);
+        }
+        ssize_t writeLen;
+        while ((writeLen = ::write(_fd, str.data(), str.size())) == -1 && errno == EAGAIN) {
+            _state->clearReady(EPOLLOUT); // 写满了, 等下一次边沿
+            if (!co_await _state->waitWritable()) { // 被取消
+                co_return std::unexpected(std::make_error_code(std::errc::operation_canceled));
+            }
+        }
+        if (writeLen == -1) {
+            co_return std::unexpected(std::error_code(errno, std::system_category()));
+        }
+        co_return static_cast<std::size_t>(writeLen);
+    }
+
+    /**
+     * @brief 读一次, 错误以 std::error_code 返回, 不抛异常
+     * @return 读到的字节数, 0 为 EOF
+     */
+    HX::ExpectedTask<std::size_t> tryRead(std::span<char> buf) {
+        if (UringLoop::isEnabled()) {
+            int bufIndex = UringLoop::get().findFixedBuffer(buf.data(), buf.size());
+            int res;
+            while ((res = co_await (bufIndex >= 0 // 落在已注册的缓冲区里就用 READ_FIXED
+                    ? UringLoop::readFixed(_fd, buf, (std::uint16_t)bufIndex, _fixedIndex)
+                    : UringLoop::read(_fd, buf, _fixedIndex))) == -EAGAIN
+            ) {
+                if ((res = co_await UringLoop::poll(_fd, POLLIN, _fixedIndex)) < 0) {
+                    break; // 被取消
+                }
+            }
+            if (res < 0) {
+                co_return std::unexpected(std::error_code(-res, std::system_category()));
+            }
+            co_return static_cast<std::size_t>(res);
+        }
+        ssize_t readLen;
+        while ((readLen = ::read(_fd, buf.data(), buf.size())) == -1 && errno == EAGAIN) {
+            _state->clearReady(EPOLLIN | EPOLLRDHUP); // 读空了, 等下一次边沿
+            if (!co_await _state->waitReadable()) { // 被取消
+                co_return std::unexpected(std::make_error_code(std::errc::operation_canceled));
+            }
+        }
+        if (readLen == -1) {
+            co_return std::unexpected(std::error_code(errno, std::system_category()));
+        }
+        co_return static_cast<std::size_t>(readLen);
+    }
+
+    /**
+     * @brief 聚集写一次 (writev, 可能只写了一部分), 只在 EAGAIN 时挂起
+     * @return 写入的字节数
+     */
+    HX::ExpectedTask<std::size_t> tryWritev(std::span<struct ::iovec const> iov) {
+        if (UringLoop::isEnabled()) {
+            int res;
+            while ((res = co_await UringLoop::writev(_fd, iov, _fixedIndex)) == -EAGAIN) {
+                if ((res = co_await UringLoop::poll(_fd, POLLOUT, _fixedIndex)) < 0) {
+                    break; // 被取消
+                }
+            }
+            if (res < 0) {
+                co_return std::unexpected(std::error_code(-res, std::system_category()));
+            }
+            co_return static_cast<std::size_t>(res);
+        }
+        ssize_t writeLen;
+        while ((writeLen = ::writev(_fd, iov.data(), (int)iov.size())) == -1 && errno == EAGAIN) {
+            _state->clearReady(EPOLLOUT);
+            if (!co_await _state->waitWritable()) { // 被取消
+                co_return std::unexpected(std::make_error_code(std::errc::operation_canceled));
+            }
+        }
+        if (writeLen == -1) {
+            co_return std::unexpected(std::error_code(errno, std::system_category()));
+        }
+        co_return static_cast<std::size_t>(writeLen);
+    }
+
+    /**
+     * @brief 分散读一次 (readv), 按顺序填满各块; 只在 EAGAIN 时挂起
+     * @return 读到的字节数, 0 为 EOF
+     */
+    HX::ExpectedTask<std::size_t> tryReadv(std::span<struct ::iovec const> iov) {
+        if (UringLoop::isEnabled()) {
+            int res;
+            while ((res = co_await UringLoop::readv(_fd, iov, _fixedIndex)) == -EAGAIN) {
+                if ((res = co_await UringLoop::poll(_fd, POLLIN, _fixedIndex)) < 0) {
+                    break; // 被取消
+                }
+            }
+            if (res < 0) {
+                co_return std::unexpected(std::error_code(-res, std::system_category()));
+            }
+            co_return static_cast<std::size_t>(res);
+        }
+        ssize_t readLen;
+        while ((readLen = ::readv(_fd, iov.data(), (int)iov.size())) == -1 && errno == EAGAIN) {
+            _state->clearReady(EPOLLIN | EPOLLRDHUP);
+            if (!co_await _state->waitReadable()) { // 被取消
+                co_return std::unexpected(std::make_error_code(std::errc::operation_canceled));
+            }
+        }
+        if (readLen == -1) {
+            co_return std::unexpected(std::error_code(errno, std::system_category()));
+        }
+        co_return static_cast<std::size_t>(readLen);
+    }
+
+    /**
+     * @brief 把 iov 里的数据全部写完: 部分写入时跳过已写完的块、截掉半块已写的部分再继续,
+     *        缓冲区写满 (EAGAIN) 才挂起. 响应头和正文可以分开放, 不必先拼接.
+     *        出错 (包括被取消) 抛 std::system_error
+     * @return 写入的总字节数
+     */
+    HX::Task<std::size_t> writeAll(std::span<struct ::iovec const> iov) {
+        // 调用方的 iov 是只读的: 每次把剩下的 (至多 kWritevBatch 块) 拷进帧里, 再修正第一块
+        std::array<struct ::iovec, kWritevBatch> batch;
+        std::size_t index = 0;  // 当前块
+        std::size_t offset = 0; // 当前块里已写的字节数
+        std::size_t total = 0;
+        while (true) {
+            while (index < iov.size() && offset == iov[index].iov_len) { // 跳过写完的 (和空的) 块
+                ++index;
+                offset = 0;
+            }
+            if (index == iov.size()) {
+                co_return total;
+            }
+            std::size_t count = std::min(kWritevBatch, iov.size() - index);
+            std::copy_n(iov.begin() + (std::ptrdiff_t)index, count, batch.begin());
+            batch[0].iov_base = (char *)batch[0].iov_base + offset;
+            batch[0].iov_len -= offset;
+            auto writeLen = co_await tryWritev({batch.data(), count});
+            if (!writeLen) {
+                throw std::system_error(writeLen.error());
+            }
+            total += *writeLen;
+            for (std::size_t left = *writeLen; left; ) { // 前移 left 字节
+                std::size_t step = std::min(left, iov[index].iov_len - offset);
+                offset += step;
+                left -= step;
+                if (offset == iov[index].iov_len) {
+                    ++index;
+                    offset = 0;
+                }
+            }
+        }
+    }
+
+    HX::Task<std::size_t> writeAll(std::string_view str) {
+        struct ::iovec iov {const_cast<char *>(str.data()), str.size()};
+        co_return co_await writeAll({&iov, 1});
+    }
+
+    /**
+     * @brief 分散读一次, 出错返回 -1 并设置 errno (同 readFile)
+     */
+    HX::Task<ssize_t> readv(std::span<struct ::iovec const> iov) {
+        auto res = co_await tryReadv(iov);
+        if (!res) {
+            errno = res.error().value();
+            co_return -1;
+        }
+        co_return static_cast<ssize_t>(*res);
+    }
+
+    /**
+     * @brief 写一次, 出错抛 std::system_error
+     */
+    HX::Task<ssize_t> writeFile(std::string_view str) {
+        auto res = co_await tryWrite(str);
+        if (!res) {
+            errno = res.error().value();
+            try {
+                HX::checkError(-1);
+            } catch(const std::exception& e) {
+                std::cerr << e.what() << " Erron: " << errno << '\n';
+                throw;
+            }
+        }
+        co_return static_cast<ssize_t>(*res);
+    }
+
+    /**
+     * @brief 读一次, 出错返回 -1 并设置 errno
+     */
+    HX::Task<ssize_t> readFile(std::span<char> buf) {
+        auto res = co_await tryRead(buf);
+        if (!res) {
+            errno = res.error().value();
+            co_return -1;
+        }
+        co_return static_cast<ssize_t>(*res);
+    }
+
+    /**
+     * @brief 逐块读到 EOF: 每次都读进同一块 buf, 交出读到的那一段;
+     *        消费者拉取下一块之前 buf 不会被覆盖, 所以内存只有这一块.
+     *        读出错 (包括被取消) 抛 std::system_error
+     */
+    HX::AsyncGenerator<std::span<char>> readChunks(std::span<char> buf) {
+        while (true) {
+            auto readLen = co_await tryRead(buf);
+            if (!readLen) {
+                throw std::system_error(readLen.error());
+            }
+            if (*readLen == 0) {
+                co_return;
+            }
+            co_yield buf.first(*readLen);
+        }
+    }
+
+    /**
+     * @brief 等待可读 (自己发起的系统调用遇到 EAGAIN 之后调用):
+     *        epoll 下清掉就绪位等下一次边沿, io_uring 下单次 poll
+     * @return false 表示被取消
+     */
+    HX::Task<bool> waitReadable() {
+        if (UringLoop::isEnabled()) {
+            int res = co_await UringLoop::poll(_fd, POLLIN, _fixedIndex);
+            co_return res >= 0;
+        }
+        _state->clearReady(EPOLLIN | EPOLLRDHUP);
+        co_return co_await _state->waitReadable();
+    }
+
+    /**
+     * @brief 等待可写, 同 waitReadable
+     */
+    HX::Task<bool> waitWritable() {
+        if (UringLoop::isEnabled()) {
+            int res = co_await UringLoop::poll(_fd, POLLOUT, _fixedIndex);
+            co_return res >= 0;
+        }
+        _state->clearReady(EPOLLOUT);
+        co_return co_await _state->waitWritable();
+    }
+
+    /**
+     * @brief 接受一个连接 (本对象须为监听 socket)
+     * @return 新连接的 fd (已是非阻塞的), 失败返回 -1 并设置 errno
+     */
+    HX::Task<int> accept() {
+        if (UringLoop::isEnabled()) {
+            int res = co_await UringLoop::accept(_fd, _fixedIndex);
+            if (res < 0) {
+                errno = -res;
+                co_return -1;
+            }
+            co_return res;
+        }
+        int fd;
+        while ((fd = ::accept4(_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) == -1
+               && errno == EAGAIN
+        ) {
+            _state->clearReady(EPOLLIN);
+            if (!co_await _state->waitReadable()) { // 被取消
+                errno = ECANCELED;
+                co_return -1;
+            }
+        }
+        co_return fd;
+    }
+
+    AsyncFile(AsyncFile &&that) noexcept
+        : _fd(that._fd)
+        , _fixedIndex(that._fixedIndex)
+        , _state(std::move(that._state))
+    {
+        that._fd = -1;
+        that._fixedIndex = -1;
+    }
+
+    AsyncFile &operator=(AsyncFile &&that) noexcept {
+        std::swap(_fd, that._fd);
+        std::swap(_fixedIndex, that._fixedIndex);
+        std::swap(_state, that._state);
+        return *this;
+    }
+
+    int getFd() const {
+        return _fd;
+    }
+
+    /**
+     * @brief epoll 注册状态; 走 io_uring 时为 nullptr
+     */
+    EpollFdState *getState() const {
+        return _state.get();
+    }
+
+    /**
+     * @brief io_uring 注册文件表中的下标, 未注册为 -1
+     */
+    int getFixedIndex() const {
+        return _fixedIndex;
+    }
+
+    /**
+     * @brief 从当前线程的循环上注销并交出 fd, 之后本对象为空;
+     *        用于把连接交给别的线程 (在那边重新构造 AsyncFile)
+     */
+    int release() {
+        if (_fixedIndex >= 0) {
+            UringLoop::get().unregisterFile(_fixedIndex);
+            _fixedIndex = -1;
+        }
+        _state.reset();
+        return std::exchange(_fd, -1);
+    }
+
+    ~AsyncFile() {
+        if (_fd == -1) {
+            return;
+        }
+        ::close(release()); // 先从循环上注销再关闭
+    }
+};
+
+inline HX::Task<void> socketConnect(
+    const AsyncFile& fd,
+    const struct sockaddr_in& sockaddr
+) {
+    if (UringLoop::isEnabled()) {
+        int res = co_await UringLoop::connect(
+            fd.getFd(), (struct sockaddr const *)&sockaddr,
+            sizeof(sockaddr), fd.getFixedIndex());
+        if (res < 0) {
+            errno = -res;
+            HX::checkError(-1);
+        }
+        co_return;
+    }
+    int res = ::connect(fd.getFd(), (struct sockaddr *)&sockaddr, sizeof(sockaddr));
+    // 非阻塞的
+    while (res == -1) [[unlikely]] {
+        if (errno == 115)
+            printf("等待连接...\n");
+        else
+            printf("socket connect error: errno=%d errmsg=%s\n", errno, strerror(errno));
+        fd.getState()->clearReady(EPOLLOUT);
+        if (!co_await fd.getState()->waitWritable()) { // 被取消
+            errno = ECANCELED;
+            HX::checkError(-1);
+        }
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (::getsockopt(fd.getFd(), SOL_SOCKET, SO_ERROR, &error, &len) == 0) {
+            if (error == 0) { // 连接成功
+                printf("连接成功~\n");
+                break;
+            } else { // 连接失败
+                printf("连接失败~\n");
+            }
+        }
+    }
+}
+
+/**
+ * @brief 创建 tcp ipv4 监听 socket (非阻塞), 出错抛 std::system_error
+ * @param reusePort 是否设置 SO_REUSEPORT: 多个线程各自监听同一端口, 由内核分发连接
+ * @param backlog 已完成握手、等待 accept 的连接队列长度 (内核再截到 net.core.somaxconn)
+ * @return 监听 socket 的 fd, 还未注册到任何循环上
+ */
+inline int createTcpListenSocketV4(const char *ip, int port, bool reusePort = false, int backlog = SOMAXCONN) {
+    int fd = HX::checkError(::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP));
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (reusePort) {
+        HX::checkError(::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)));
+    }
+    struct sockaddr_in sockaddr;
+    std::memset(&sockaddr, 0, sizeof(sockaddr));
+    sockaddr.sin_family = AF_INET;
+    sockaddr.sin_addr.s_addr = inet_addr(ip);
+    sockaddr.sin_port = htons(port);
+    try {
+        HX::checkError(::bind(fd, (struct sockaddr *)&sockaddr, sizeof(sockaddr)));
+        HX::checkError(::listen(fd, backlog));
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    return fd;
+}
+
+/**
+ * @brief 创建tcp ipv4 连接
+ * @param ip 只能是ipv4的 xxx.xxx.xxx.xxx 的 ip
+ * @param post
+ * @return HX::Task<AsyncFile>
+ */
+inline HX::Task<AsyncFile> createTcpClientByIpV4(const char *ip, int port) {
+    AsyncFile res(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    struct sockaddr_in sockaddr;
+    std::memset(&sockaddr, 0, sizeof(sockaddr));
+    sockaddr.sin_family = AF_INET;
+    sockaddr.sin_addr.s_addr = inet_addr(ip);
+    sockaddr.sin_port = htons(port);
+
+    co_await socketConnect(res, sockaddr);
+    co_return std::move(res);
+}
+
+} // namespace HX
+
+#endif // !_HX_ASYNC_FILE_H_
@@ -0,0 +1,233 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-18 19:37:52
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_ASYNC_GENERATOR_H_
+#define _HX_ASYNC_GENERATOR_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+#include "Task.hpp"
+#include "FrameAllocator.hpp"
+
+namespace HX {
+
+/**
+ * @brief 异步生成器: 生产者里可以 co_await (读 socket 等), 每次 co_yield 交出一个元素
+ *
+ * 消费者:
+ * ```cpp
+ * for (auto it = co_await gen.begin(); it != gen.end(); co_await ++it) {
+ *     use(*it);
+ * }
+ * ```
+ * 自带背压: 生产者在 co_yield 处挂起 (对称转移回消费者), 直到消费者 ++ 才继续,
+ * 所以生产者可以一直复用同一块缓冲区, 元素只是它的地址 (不拷贝), 在下一次 ++ 之前有效.
+ * 取消令牌在每次拉取时从消费者继承 (没有单独指定时), 生产者里的等待可以被取消.
+ * 生产者的异常从 begin() / ++ 处重新抛出.
+ * @tparam T 元素类型, 如 std::span<char>
+ */
+template <class T>
+class [[nodiscard]] AsyncGenerator {
+    static_assert(!std::is_reference_v<T>, "AsyncGenerator<T>: T 必须是对象类型");
+
+public:
+    struct promise_type {
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        /**
+         * @brief 交出元素或结束时都转回消费者
+         */
+        struct ConsumerAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> coroutine
+            ) const noexcept {
+                return coroutine.promise()._consumer;
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        ConsumerAwaiter final_suspend() noexcept {
+            _value = nullptr;
+            return {};
+        }
+
+        void unhandled_exception() noexcept {
+            _exception = std::current_exception();
+        }
+
+        void return_void() noexcept {}
+
+        ConsumerAwaiter yield_value(T &value) noexcept {
+            _value = std::addressof(value);
+            return {};
+        }
+
+        ConsumerAwaiter yield_value(T &&value) noexcept {
+            _value = std::addressof(value); // 临时对象活到生产者恢复
+            return {};
+        }
+
+        AsyncGenerator get_return_object() noexcept {
+            return AsyncGenerator {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+#if !HX_NO_FRAME_POOL
+        static void *operator new(std::size_t size) {
+            return HX::FrameAllocator::allocate(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept {
+            HX::FrameAllocator::deallocate(ptr, size);
+        }
+#endif
+
+        promise_type &operator=(promise_type &&) = delete;
+
+        T *_value = nullptr;                  // 当前元素, 结束后为 nullptr
+        std::coroutine_handle<> _consumer {}; // 正在拉取的消费者
+        std::exception_ptr _exception {};
+        std::stop_token _stopToken {};        // 取消令牌, 拉取时从消费者继承
+    };
+
+    class iterator;
+
+    /**
+     * @brief 拉取下一个元素: 恢复生产者, 直到它 co_yield 或结束
+     */
+    struct PullAwaiter {
+        bool await_ready() const noexcept {
+            return !_coroutine || _coroutine.done();
+        }
+
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> consumer) const noexcept {
+            auto &promise = _coroutine.promise();
+            promise._consumer = consumer;
+            if constexpr (HasStopToken<P>) {
+                if (!promise._stopToken.stop_possible()) {
+                    promise._stopToken = consumer.promise()._stopToken;
+                }
+            }
+            return _coroutine;
+        }
+
+        iterator await_resume() const {
+            if (_coroutine && _coroutine.promise()._exception) [[unlikely]] {
+                std::rethrow_exception(std::exchange(_coroutine.promise()._exception, nullptr));
+            }
+            return iterator {_coroutine};
+        }
+
+        std::coroutine_handle<promise_type> _coroutine;
+    };
+
+    class iterator {
+    public:
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        explicit iterator(std::coroutine_handle<promise_type> coroutine) noexcept
+            : _coroutine(coroutine)
+        {}
+
+        T &operator*() const noexcept {
+            return *_coroutine.promise()._value;
+        }
+
+        T *operator->() const noexcept {
+            return _coroutine.promise()._value;
+        }
+
+        /**
+         * @brief `co_await ++it`
+         */
+        PullAwaiter operator++() const noexcept {
+            return {_coroutine};
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept {
+            return !_coroutine || _coroutine.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> _coroutine {};
+    };
+
+    AsyncGenerator() noexcept = default;
+
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> coroutine) noexcept
+        : _coroutine(coroutine)
+    {}
+
+    AsyncGenerator(AsyncGenerator &&that) noexcept : _coroutine(that._coroutine) {
+        that._coroutine = nullptr;
+    }
+
+    AsyncGenerator &operator=(AsyncGenerator &&that) noexcept {
+        std::swap(_coroutine, that._coroutine);
+        return *this;
+    }
+
+    ~AsyncGenerator() {
+        if (_coroutine)
+            _coroutine.destroy(); // 生产者须挂在 co_yield 处 (或还没开始/已结束)
+    }
+
+    /**
+     * @brief `co_await gen.begin()`: 运行到第一个元素; 只能调用一次
+     */
+    PullAwaiter begin() const noexcept {
+        return {_coroutine};
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return {};
+    }
+
+    /**
+     * @brief 单独指定取消令牌 (否则拉取时继承消费者的)
+     */
+    AsyncGenerator &setStopToken(std::stop_token token) noexcept {
+        _coroutine.promise()._stopToken = std::move(token);
+        return *this;
+    }
+
+private:
+    std::coroutine_handle<promise_type> _coroutine {};
+};
+
+} // namespace HX
+
+#endif // !_HX_ASYNC_GENERATOR_H_
@@ -0,0 +1,215 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 20:14:08
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_ASYNC_LISTENER_H_
+#define _HX_ASYNC_LISTENER_H_
+
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Task.hpp"
+#include "AsyncFile.hpp"
+#include "TimerLoop.hpp"
+#include "EpollLoop.hpp"
+#include "UringLoop.hpp"
+
+namespace HX {
+
+/**
+ * @brief 监听选项 (AsyncListener / ReactorPool::listen)
+ */
+struct ListenerOptions {
+    int backlog = SOMAXCONN;     // listen 的队列长度 (内核再截到 net.core.somaxconn)
+    bool reusePort = false;      // SO_REUSEPORT: 每个循环各开一个监听 socket, 由内核分发连接
+    bool exclusive = false;      // EPOLLEXCLUSIVE: 多个循环共用同一个监听 socket, 一个连接只唤醒其中一个
+    std::size_t maxBatch = 64;   // 每次就绪最多连续 accept 几个 (也是已接受、未取走的连接的上限)
+};
+
+/**
+ * @brief 监听 socket: `co_await listener.accept()` 得到一个已连接的 AsyncFile
+ *
+ * 每次就绪都用 accept4(SOCK_NONBLOCK | SOCK_CLOEXEC) 连续接受, 直到 EAGAIN 或攒满 maxBatch 个,
+ * 之后的 accept 先从攒下的里面取, 取完才再进内核; 返回的 AsyncFile 已是非阻塞的, 不再 fcntl.
+ * fd 用尽 (EMFILE / ENFILE) 时先关掉预留的 fd, 接受一个连接并立即关闭, 再把预留的 fd 开回来:
+ * 连接风暴里丢掉多出来的连接, 而不是让它们堵在队列里 (边沿触发下也不会再有新的通知).
+ * 被丢掉的个数见 dropped().
+ */
+class AsyncListener : public AsyncFile {
+public:
+    /**
+     * @param fd 已在监听的非阻塞 socket, 之后归本对象所有
+     */
+    explicit AsyncListener(int fd, ListenerOptions const &options = {})
+        : _maxBatch(options.maxBatch ? options.maxBatch : 1)
+        , _spareFd(openSpare())
+    {
+        _fd = fd; // 之后构造失败, 由基类析构关闭它
+        try {
+            if (UringLoop::isEnabled()) { // 同 AsyncFile: 走 io_uring 就不用挂 epoll 了
+                _fixedIndex = UringLoop::get().registerFile(_fd);
+                return;
+            }
+            _state = std::make_unique<EpollFdState>(_fd, options.exclusive
+                ? EPOLLIN | EPOLLET | EPOLLEXCLUSIVE // EPOLLEXCLUSIVE 不能与 EPOLLRDHUP 一起注册
+                : EpollFdState::kDefaultEvents);
+        } catch (...) { // 构造没完成就不会调本类的析构
+            if (_spareFd != -1) {
+                ::close(_spareFd);
+            }
+            throw;
+        }
+    }
+
+    /**
+     * @brief 创建并监听 ip:port (出错抛 std::system_error)
+     */
+    AsyncListener(const char *ip, int port, ListenerOptions const &options = {})
+        : AsyncListener(createTcpListenSocketV4(ip, port, options.reusePort, options.backlog), options)
+    {}
+
+    AsyncListener &operator=(AsyncListener &&) = delete;
+
+    ~AsyncListener() {
+        for (int fd : _accepted) {
+            ::close(fd);
+        }
+        if (_spareFd != -1) {
+            ::close(_spareFd);
+        }
+    }
+
+    /**
+     * @brief 接受一个连接; 被取消或出现无法恢复的错误时抛 std::system_error
+     */
+    Task<AsyncFile> accept() {
+        while (_accepted.empty()) {
+            bool drained = drain();
+            if (!_accepted.empty()) {
+                break;
+            }
+            if (drained) { // 内核队列已空, 等下一次就绪
+                bool ready = co_await waitReadable();
+                if (!ready) {
+                    throw std::system_error(ECANCELED, std::system_category());
+                }
+            } else { // 整批都丢掉了, 让出一轮再继续
+                co_await YieldAwaiter();
+            }
+        }
+        int fd = _accepted.front();
+        _accepted.pop_front();
+        co_return AsyncFile(fd, true);
+    }
+
+    /**
+     * @brief 因 fd 用尽而丢掉的连接数
+     */
+    std::size_t dropped() const noexcept {
+        return _dropped;
+    }
+
+private:
+    /**
+     * @brief 放回任务队列末尾, 下一轮循环再恢复
+     */
+    struct YieldAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) {
+            TimerLoop::getLoop().addTask(coroutine);
+        }
+
+        void await_resume() const noexcept {
+        }
+    };
+
+    static int openSpare() noexcept {
+        return ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+
+    /**
+     * @brief 从内核的队列里连续接受 (至多 _maxBatch 次, 只在 _accepted 为空时调用), 直到读空
+     * @return 是否读空了 (EAGAIN); 出错时攒下的连接照常交出, 一个都没有才抛出
+     */
+    bool drain() {
+        for (std::size_t tries = 0; tries < _maxBatch; ++tries) {
+            int fd = ::accept4(_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd != -1) {
+                _accepted.push_back(fd);
+                continue;
+            }
+            switch (errno) {
+            case EAGAIN:
+                return true;
+            case EINTR:
+            case ECONNABORTED: // 握手完成后对端又重置了
+            case EPROTO:
+                break;
+            case EMFILE:
+            case ENFILE:
+                if (!_accepted.empty()) { // 先把手上的交出去, 它们关闭后就有 fd 了
+                    return false;
+                }
+                if (_spareFd == -1 && (_spareFd = openSpare()) == -1) { // 连预留的都没能开回来
+                    throw std::system_error(EMFILE, std::system_category());
+                }
+                shed();
+                break;
+            default:
+                if (!_accepted.empty()) {
+                    return false;
+                }
+                throw std::system_error(errno, std::system_category());
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 腾出预留的 fd, 接受一个连接并立即关闭
+     */
+    void shed() noexcept {
+        ::close(_spareFd);
+        int fd = ::accept4(_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd != -1) {
+            ::close(fd);
+            ++_dropped;
+        }
+        _spareFd = openSpare();
+    }
+
+    std::deque<int> _accepted; // 已接受、还没取走的连接
+    std::size_t _maxBatch;
+    std::size_t _dropped = 0;
+    int _spareFd; // 预留的 fd, 用尽时腾出来丢弃连接
+};
+
+} // namespace HX
+
+#endif // !_HX_ASYNC_LISTENER_H_
@@ -0,0 +1,87 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 10:31:12
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_ASYNC_LOOP_H_
+#define _HX_ASYNC_LOOP_H_
+
+#include <chrono>
+
+#include "TimerLoop.hpp"
+#include "EpollLoop.hpp"
+#include "UringLoop.hpp"
+
+namespace HX {
+
+/**
+ * @brief 事件循环: 任务队列 + 计时器 + 文件事件, 唯一的等待点是 epoll_wait;
+ *        开启 io_uring 时唯一的等待点是 io_uring_enter (epoll fd 由它代为监听)
+ *
+ * 驱动的是当前线程的 TimerLoop/EpollLoop/UringLoop, 每个线程可以各跑一个.
+ */
+struct AsyncLoop {
+    /**
+     * @brief 让 run() 在本轮结束后返回 (只能在运行循环的线程上调用)
+     */
+    void stop() noexcept {
+        _stopped = true;
+    }
+
+    void run() {
+        auto &timerLoop = TimerLoop::getLoop();
+        if (UringLoop::isEnabled()) {
+            runUring(timerLoop);
+            return;
+        }
+        auto &epollLoop = EpollLoop::get();
+        while (!_stopped) {
+            timerLoop.runTasks();
+            auto timeout = timerLoop.run(); // 顺带把 timerfd 设到下一个到期时间
+            if (timerLoop.hasTask()) {
+                timeout = std::chrono::system_clock::duration::zero();
+            }
+            // 每轮都会回到 epoll_wait, 计时器再多也不会饿死文件事件
+            if (!epollLoop.run(timeout)) {
+                break;
+            }
+        }
+    }
+
+private:
+    void runUring(TimerLoop &timerLoop) {
+        auto &uringLoop = UringLoop::get();
+        // io_uring_enter 能带超时就不必再让 timerfd 唤醒
+        timerLoop.useTimerFd(!uringLoop.canWaitTimeout());
+        while (!_stopped) {
+            timerLoop.runTasks();
+            auto timeout = timerLoop.run();
+            if (timerLoop.hasTask()) {
+                timeout = std::chrono::system_clock::duration::zero();
+            }
+            if (!uringLoop.run(timeout)) {
+                break;
+            }
+        }
+    }
+
+    bool _stopped = false;
+};
+
+} // namespace HX
+
+#endif // !_HX_ASYNC_LOOP_H_
@@ -0,0 +1,343 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-22 10:18:26
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_ASYNC_STREAM_H_
+#define _HX_ASYNC_STREAM_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Task.hpp"
+#include "AsyncFile.hpp"
+#include "CheckError.hpp"
+
+namespace HX {
+
+/**
+ * @brief 镜像环形缓冲区: 同一块内存 (memfd) 连续映射两次,
+ *        所以从任意位置开始、长度不超过容量的一段在地址上总是连续的, 跨过环尾也不用拷贝
+ *
+ * 容量向上取整到页大小的 2 的幂. 读写位置是单调递增的计数, 取模后才是偏移.
+ */
+class RingBuffer {
+public:
+    explicit RingBuffer(std::size_t capacity) {
+        std::size_t page = (std::size_t)::sysconf(_SC_PAGESIZE);
+        _capacity = page;
+        while (_capacity < capacity) {
+            _capacity <<= 1;
+        }
+        int fd = HX::checkError(::memfd_create("hx-ring", MFD_CLOEXEC));
+        void *base = MAP_FAILED;
+        try {
+            HX::checkError(::ftruncate(fd, (off_t)_capacity));
+            // 先占下两倍的地址空间, 再把同一个 fd 固定映射到前后两半
+            base = checkMap(::mmap(nullptr, 2 * _capacity, PROT_NONE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            auto *half = static_cast<char *>(base);
+            checkMap(::mmap(half, _capacity, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_FIXED, fd, 0));
+            checkMap(::mmap(half + _capacity, _capacity, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_FIXED, fd, 0));
+        } catch (...) {
+            if (base != MAP_FAILED) {
+                ::munmap(base, 2 * _capacity);
+            }
+            ::close(fd);
+            throw;
+        }
+        ::close(fd); // 映射持有 memfd 的引用
+        _data = static_cast<char *>(base);
+    }
+
+    RingBuffer &operator=(RingBuffer &&) = delete;
+
+    ~RingBuffer() {
+        ::munmap(_data, 2 * _capacity);
+    }
+
+    std::size_t capacity() const noexcept {
+        return _capacity;
+    }
+
+    /**
+     * @brief 已写入还没读走的字节数
+     */
+    std::size_t size() const noexcept {
+        return (std::size_t)(_tail - _head);
+    }
+
+    std::size_t space() const noexcept {
+        return _capacity - size();
+    }
+
+    bool empty() const noexcept {
+        return _tail == _head;
+    }
+
+    /**
+     * @brief 可读的数据 (连续)
+     */
+    std::string_view data() const noexcept {
+        return {_data + (_head & (_capacity - 1)), size()};
+    }
+
+    /**
+     * @brief 可写的空间 (连续), 写完调用 produce
+     */
+    std::span<char> writable() noexcept {
+        return {_data + (_tail & (_capacity - 1)), space()};
+    }
+
+    void produce(std::size_t n) noexcept {
+        _tail += n;
+    }
+
+    void consume(std::size_t n) noexcept {
+        _head += n;
+    }
+
+private:
+    static void *checkMap(void *ptr) {
+        if (ptr == MAP_FAILED) {
+            HX::checkError(-1);
+        }
+        return ptr;
+    }
+
+    char *_data = nullptr;
+    std::size_t _capacity = 0; // 2 的幂
+    std::uint64_t _head = 0;   // 读位置
+    std::uint64_t _tail = 0;   // 写位置
+};
+
+/**
+ * @brief 带缓冲的读: 一次 read 尽量读满环形缓冲区, 按分隔符/长度切出的结果是指向缓冲区的 string_view, 不拷贝
+ *
+ * 返回的 string_view 在下一次调用本对象的读方法前有效.
+ * 读出错 (包括被取消) 抛 std::system_error; 要的数据超过缓冲区容量抛 no_buffer_space.
+ * 不拥有 file, 可以与 AsyncWriter 共用同一个 AsyncFile.
+ */
+class AsyncReader {
+public:
+    explicit AsyncReader(AsyncFile &file, std::size_t capacity = 64 * 1024)
+        : _file(file)
+        , _buffer(capacity)
+    {}
+
+    AsyncReader &operator=(AsyncReader &&) = delete;
+
+    /**
+     * @brief 已缓冲的数据 (不读, 不消费)
+     */
+    std::string_view buffered() const noexcept {
+        return _buffer.data();
+    }
+
+    /**
+     * @brief 缓冲区为空时读一次; 返回已缓冲的全部数据 (不消费), EOF 时为空
+     */
+    Task<std::string_view> peek() {
+        if (_buffer.empty()) {
+            co_await fill();
+        }
+        co_return _buffer.data();
+    }
+
+    /**
+     * @brief 丢掉缓冲区开头的 n 字节 (配合 peek 使用)
+     */
+    void consume(std::size_t n) noexcept {
+        _buffer.consume(std::min(n, _buffer.size()));
+    }
+
+    /**
+     * @brief 读到分隔符为止
+     * @return 包含分隔符的一段; 先遇到 EOF 则返回剩下的全部 (不含分隔符);
+     *         EOF 且什么都没剩下为 std::nullopt
+     */
+    Task<std::optional<std::string_view>> readUntil(std::string_view delim) {
+        std::size_t scanned = 0; // 已经找过的部分不再重找
+        while (true) {
+            auto data = _buffer.data();
+            std::size_t pos = data.find(delim, scanned);
+            if (pos != std::string_view::npos) {
+                co_return take(pos + delim.size());
+            }
+            if (data.size() >= delim.size()) {
+                scanned = data.size() - delim.size() + 1;
+            }
+            std::size_t n = co_await fill();
+            if (n == 0) {
+                if (_buffer.empty()) {
+                    co_return std::nullopt;
+                }
+                co_return take(_buffer.size());
+            }
+        }
+    }
+
+    /**
+     * @brief 读一行
+     * @return 不含行尾 ("\n" 或 "\r\n") 的一行, 空行为空串; EOF 且什么都没剩下为 std::nullopt
+     */
+    Task<std::optional<std::string_view>> readLine() {
+        auto line = co_await readUntil("\n");
+        if (line && line->ends_with('\n')) {
+            line->remove_suffix(1);
+            if (line->ends_with('\r')) {
+                line->remove_suffix(1);
+            }
+        }
+        co_return line;
+    }
+
+    /**
+     * @brief 读满 n 字节
+     * @return n 字节; 不足 n 字节就遇到 EOF 则返回剩下的全部
+     */
+    Task<std::string_view> readExactly(std::size_t n) {
+        if (n > _buffer.capacity()) [[unlikely]] {
+            throw std::system_error(std::make_error_code(std::errc::no_buffer_space));
+        }
+        while (_buffer.size() < n) {
+            std::size_t got = co_await fill();
+            if (got == 0) {
+                co_return take(_buffer.size());
+            }
+        }
+        co_return take(n);
+    }
+
+private:
+    /**
+     * @brief 读一次追加到缓冲区末尾
+     * @return 读到的字节数, 0 为 EOF
+     */
+    Task<std::size_t> fill() {
+        if (!_buffer.space()) [[unlikely]] {
+            throw std::system_error(std::make_error_code(std::errc::no_buffer_space));
+        }
+        auto readLen = co_await _file.tryRead(_buffer.writable());
+        if (!readLen) {
+            throw std::system_error(readLen.error());
+        }
+        _buffer.produce(*readLen);
+        co_return *readLen;
+    }
+
+    /**
+     * @brief 切下开头 n 字节; 数据留在原处, 直到下一次 fill 才可能被覆盖
+     */
+    std::string_view take(std::size_t n) noexcept {
+        auto res = _buffer.data().substr(0, n);
+        _buffer.consume(n);
+        return res;
+    }
+
+    AsyncFile &_file;
+    RingBuffer _buffer;
+};
+
+/**
+ * @brief 带缓冲的写: 小块写入先攒在环形缓冲区里, 攒到阈值或显式 flush() 才写出去
+ *
+ * 放不下的大块先 flush 再直接写, 不经过缓冲区.
+ * 写出错 (包括被取消) 抛 std::system_error. 析构时不会自动 flush (不能在析构里 co_await).
+ * 不拥有 file.
+ */
+class AsyncWriter {
+public:
+    /**
+     * @param flushThreshold 缓冲的数据达到这么多就写出去; 0 表示缓冲区容量的一半
+     */
+    explicit AsyncWriter(AsyncFile &file, std::size_t capacity = 64 * 1024, std::size_t flushThreshold = 0)
+        : _file(file)
+        , _buffer(capacity)
+        , _flushThreshold(flushThreshold ? std::min(flushThreshold, _buffer.capacity())
+                                         : _buffer.capacity() / 2)
+    {}
+
+    AsyncWriter &operator=(AsyncWriter &&) = delete;
+
+    /**
+     * @brief 还没写出去的字节数
+     */
+    std::size_t buffered() const noexcept {
+        return _buffer.size();
+    }
+
+    Task<void> write(std::string_view data) {
+        if (data.size() > _buffer.space()) {
+            co_await flush();
+            if (data.size() >= _flushThreshold) { // 反正要立即写出去, 不必先拷进缓冲区
+                co_await writeAll(data);
+                co_return;
+            }
+        }
+        std::memcpy(_buffer.writable().data(), data.data(), data.size());
+        _buffer.produce(data.size());
+        if (_buffer.size() >= _flushThreshold) {
+            co_await flush();
+        }
+    }
+
+    /**
+     * @brief 把缓冲的数据全部写出去
+     */
+    Task<void> flush() {
+        while (!_buffer.empty()) {
+            std::size_t n = co_await writeSome(_buffer.data());
+            _buffer.consume(n);
+        }
+    }
+
+private:
+    Task<std::size_t> writeSome(std::string_view data) {
+        auto writeLen = co_await _file.tryWrite(data);
+        if (!writeLen) {
+            throw std::system_error(writeLen.error());
+        }
+        co_return *writeLen;
+    }
+
+    Task<void> writeAll(std::string_view data) {
+        while (!data.empty()) {
+            std::size_t n = co_await writeSome(data);
+            data.remove_prefix(n);
+        }
+    }
+
+    AsyncFile &_file;
+    RingBuffer _buffer;
+    std::size_t _flushThreshold;
+};
+
+} // namespace HX
+
+#endif // !_HX_ASYNC_STREAM_H_
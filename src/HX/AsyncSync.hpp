@@ -0,0 +1,398 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-19 16:08:33
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_ASYNC_SYNC_H_
+#define _HX_ASYNC_SYNC_H_
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "TimerLoop.hpp"
+#include "EpollLoop.hpp"
+
+namespace HX {
+
+/**
+ * @brief 等待者: 嵌在 co_await 的等待者对象 (协程帧) 里, 挂入等待队列不申请内存
+ */
+struct AsyncWaiter {
+    std::coroutine_handle<> _coroutine {};
+    AsyncWaiter *_next = nullptr;
+};
+
+/**
+ * @brief 侵入式 FIFO 等待队列 (不加锁, 由使用者保证互斥)
+ */
+class AsyncWaiterQueue {
+public:
+    bool empty() const noexcept {
+        return !_head;
+    }
+
+    void push(AsyncWaiter &waiter) noexcept {
+        waiter._next = nullptr;
+        if (_tail) {
+            _tail->_next = &waiter;
+        } else {
+            _head = &waiter;
+        }
+        _tail = &waiter;
+    }
+
+    /**
+     * @brief 放回队首 (取出后发现不能满足它时, 保持它的先后顺序)
+     */
+    void pushFront(AsyncWaiter &waiter) noexcept {
+        waiter._next = _head;
+        _head = &waiter;
+        if (!_tail) {
+            _tail = &waiter;
+        }
+    }
+
+    AsyncWaiter *pop() noexcept {
+        auto *waiter = _head;
+        if (waiter) {
+            _head = waiter->_next;
+            if (!_head) {
+                _tail = nullptr;
+            }
+        }
+        return waiter;
+    }
+
+    /**
+     * @brief 全部放进当前线程的任务队列, 由循环恢复
+     */
+    void resumeAll() {
+        while (auto *waiter = pop()) {
+            TimerLoop::getLoop().addTask(waiter->_coroutine);
+        }
+    }
+
+private:
+    AsyncWaiter *_head = nullptr;
+    AsyncWaiter *_tail = nullptr;
+};
+
+class AsyncMutex;
+
+/**
+ * @brief 持有锁的 RAII 守卫, 析构时解锁
+ */
+class [[nodiscard]] AsyncLockGuard {
+public:
+    explicit AsyncLockGuard(AsyncMutex &mutex) noexcept : _mutex(&mutex) {}
+
+    AsyncLockGuard(AsyncLockGuard &&that) noexcept : _mutex(std::exchange(that._mutex, nullptr)) {}
+
+    AsyncLockGuard &operator=(AsyncLockGuard &&) = delete;
+
+    ~AsyncLockGuard();
+
+private:
+    AsyncMutex *_mutex;
+};
+
+/**
+ * @brief 协程互斥锁: 等锁的协程挂起, 不会阻塞循环
+ *
+ * 状态是一个原子字: 未上锁 / 上锁无人等 / 上锁且指向新来等待者的 LIFO 栈.
+ * 加锁与无人等待时的解锁各是一次 CAS, 不加锁, 可以在多个反应堆线程间共享.
+ * 解锁者一次性把 LIFO 栈取下来反转成 FIFO (只有持锁者访问), 按到达顺序把锁直接交给下一个等待者,
+ * 并把它投递回它自己挂起时所在的循环 (EpollLoop::post) 恢复, 不在 unlock 里嵌套运行它;
+ * 所以跨反应堆共享时, 等待者仍在自己的反应堆上继续, 不会被带到解锁者的线程.
+ */
+class AsyncMutex {
+    static constexpr std::uintptr_t kNotLocked = 1;
+    static constexpr std::uintptr_t kLockedNoWaiters = 0;
+
+    struct Waiter : AsyncWaiter {
+        EpollLoop *_loop = nullptr; // 等待者所在线程的循环, 真的挂起了才有
+        EpollLoop::ResumeNode _resumeNode; // 交锁时投递的节点, 不申请内存
+    };
+
+public:
+    AsyncMutex() noexcept = default;
+
+    AsyncMutex &operator=(AsyncMutex &&) = delete;
+
+    struct LockAwaiter : Waiter {
+        bool await_ready() noexcept {
+            return _mutex.tryLock();
+        }
+
+        bool await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            this->_coroutine = coroutine;
+            this->_resumeNode._coroutine = coroutine;
+            // 先占住循环: 一旦入栈, 解锁者随时可能把它投递回来
+            this->_loop = &EpollLoop::get();
+            this->_loop->acquire();
+            auto old = _mutex._state.load(std::memory_order_acquire);
+            while (true) {
+                if (old == kNotLocked) { // 恰好被释放了, 直接拿锁
+                    if (_mutex._state.compare_exchange_weak(
+                            old, kLockedNoWaiters,
+                            std::memory_order_acquire, std::memory_order_relaxed)) {
+                        std::exchange(this->_loop, nullptr)->release();
+                        return false;
+                    }
+                    continue;
+                }
+                this->_next = old == kLockedNoWaiters ? nullptr : reinterpret_cast<AsyncWaiter *>(old);
+                if (_mutex._state.compare_exchange_weak(
+                        old, reinterpret_cast<std::uintptr_t>(static_cast<AsyncWaiter *>(this)),
+                        std::memory_order_release, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+        void await_resume() const noexcept {
+            if (this->_loop) {
+                this->_loop->release();
+            }
+        }
+
+        AsyncMutex &_mutex;
+    };
+
+    struct ScopedLockAwaiter : LockAwaiter {
+        AsyncLockGuard await_resume() const noexcept {
+            LockAwaiter::await_resume();
+            return AsyncLockGuard {this->_mutex};
+        }
+    };
+
+    bool tryLock() noexcept {
+        auto old = kNotLocked;
+        return _state.compare_exchange_strong(
+            old, kLockedNoWaiters, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief `co_await mutex.lock();` 之后须 unlock()
+     */
+    LockAwaiter lock() noexcept {
+        return {{}, *this};
+    }
+
+    /**
+     * @brief `auto guard = co_await mutex.scopedLock();`
+     */
+    ScopedLockAwaiter scopedLock() noexcept {
+        return {{{}, *this}};
+    }
+
+    /**
+     * @brief 解锁; 有人在等则把锁交给最早来的那个
+     */
+    void unlock() {
+        if (!_waiters) {
+            auto old = kLockedNoWaiters;
+            if (_state.compare_exchange_strong(
+                    old, kNotLocked, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+            // 有新的等待者: 取下 LIFO 栈, 反转成 FIFO
+            old = _state.exchange(kLockedNoWaiters, std::memory_order_acquire);
+            auto *waiter = reinterpret_cast<AsyncWaiter *>(old);
+            do {
+                auto *next = waiter->_next;
+                waiter->_next = _waiters;
+                _waiters = waiter;
+                waiter = next;
+            } while (waiter);
+        }
+        auto *next = static_cast<Waiter *>(std::exchange(_waiters, _waiters->_next)); // 锁直接交给它, 状态保持上锁
+        next->_loop->post(next->_resumeNode); // 之后等待者可能立即被恢复并销毁, 不能再碰它
+    }
+
+private:
+    std::atomic<std::uintptr_t> _state {kNotLocked};
+    AsyncWaiter *_waiters = nullptr; // 已转成 FIFO 的等待者, 只有持锁者访问
+};
+
+inline AsyncLockGuard::~AsyncLockGuard() {
+    if (_mutex) {
+        _mutex->unlock();
+    }
+}
+
+/**
+ * @brief 协程计数信号量 (单线程, 在同一个循环上使用); 释放时按到达顺序唤醒等待者
+ */
+class AsyncSemaphore {
+public:
+    explicit AsyncSemaphore(std::size_t count) noexcept : _count(count) {}
+
+    AsyncSemaphore &operator=(AsyncSemaphore &&) = delete;
+
+    struct AcquireAwaiter : AsyncWaiter {
+        bool await_ready() noexcept {
+            return _semaphore.tryAcquire();
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            _coroutine = coroutine;
+            _semaphore._waiters.push(*this);
+        }
+
+        void await_resume() const noexcept {}
+
+        AsyncSemaphore &_semaphore;
+    };
+
+    bool tryAcquire() noexcept {
+        if (_count) {
+            --_count;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief `co_await sem.acquire();` 没有名额则挂起
+     */
+    AcquireAwaiter acquire() noexcept {
+        return {{}, *this};
+    }
+
+    /**
+     * @brief 归还 n 个名额: 先直接交给等待者, 剩下的计入计数
+     */
+    void release(std::size_t n = 1) {
+        for (; n; --n) {
+            auto *waiter = _waiters.pop();
+            if (!waiter) {
+                _count += n;
+                return;
+            }
+            TimerLoop::getLoop().addTask(waiter->_coroutine);
+        }
+    }
+
+    std::size_t available() const noexcept {
+        return _count;
+    }
+
+private:
+    std::size_t _count;
+    AsyncWaiterQueue _waiters;
+};
+
+/**
+ * @brief 手动复位事件 (单线程): set() 唤醒全部等待者, 之后的等待直接通过, 直到 reset()
+ */
+class AsyncManualResetEvent {
+public:
+    explicit AsyncManualResetEvent(bool set = false) noexcept : _set(set) {}
+
+    AsyncManualResetEvent &operator=(AsyncManualResetEvent &&) = delete;
+
+    struct WaitAwaiter : AsyncWaiter {
+        bool await_ready() const noexcept {
+            return _event._set;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            _coroutine = coroutine;
+            _event._waiters.push(*this);
+        }
+
+        void await_resume() const noexcept {}
+
+        AsyncManualResetEvent &_event;
+    };
+
+    WaitAwaiter wait() noexcept {
+        return {{}, *this};
+    }
+
+    void set() {
+        _set = true;
+        _waiters.resumeAll();
+    }
+
+    void reset() noexcept {
+        _set = false;
+    }
+
+    bool isSet() const noexcept {
+        return _set;
+    }
+
+private:
+    bool _set;
+    AsyncWaiterQueue _waiters;
+};
+
+/**
+ * @brief 一次性的倒数门闩 (单线程): 计数减到 0 时唤醒全部等待者
+ */
+class AsyncLatch {
+public:
+    explicit AsyncLatch(std::size_t count) noexcept : _count(count) {}
+
+    AsyncLatch &operator=(AsyncLatch &&) = delete;
+
+    struct WaitAwaiter : AsyncWaiter {
+        bool await_ready() const noexcept {
+            return _latch._count == 0;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            _coroutine = coroutine;
+            _latch._waiters.push(*this);
+        }
+
+        void await_resume() const noexcept {}
+
+        AsyncLatch &_latch;
+    };
+
+    WaitAwaiter wait() noexcept {
+        return {{}, *this};
+    }
+
+    void countDown(std::size_t n = 1) {
+        if (_count == 0) {
+            return;
+        }
+        _count = n >= _count ? 0 : _count - n;
+        if (_count == 0) {
+            _waiters.resumeAll();
+        }
+    }
+
+    bool tryWait() const noexcept {
+        return _count == 0;
+    }
+
+private:
+    std::size_t _count;
+    AsyncWaiterQueue _waiters;
+};
+
+} // namespace HX
+
+#endif // !_HX_ASYNC_SYNC_H_
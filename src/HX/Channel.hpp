@@ -0,0 +1,347 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-20 10:52:17
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_CHANNEL_H_
+#define _HX_CHANNEL_H_
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "EpollLoop.hpp"
+#include "AsyncSync.hpp"
+#include "Uninitialized.hpp"
+
+namespace HX {
+
+/**
+ * @brief 有界 MPMC 通道: 协程之间、线程之间传递 T
+ *
+ * 数据放在 Vyukov 有界队列 (每个槽一个序号) 里, 没有人在等时收发都只是一次 CAS, 不加锁.
+ * 满了 `co_await send` 挂起, 空了 `co_await recv` 挂起; 挂起的一方登记在锁保护的等待队列里,
+ * 对方收发成功后看到有人在等 (一个原子计数), 才加锁替它完成操作 (值直接放进它的等待者里),
+ * 再通过它所在线程的 EpollLoop::post 唤醒它 (在别的线程上则走 eventfd).
+ * 挂起期间计入所在 EpollLoop 的等待数, 循环不会因为无事可做而退出.
+ *
+ * 没有循环的线程 (如普通线程池) 用 trySend / tryRecv.
+ * close() 之后: send 返回 false; recv 取完剩下的值后返回 std::nullopt.
+ * 析构时不能还有协程在等.
+ * @tparam T 值类型
+ * @tparam N 容量, 2 的幂
+ */
+template <class T, std::size_t N>
+class Channel {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Channel<T, N>: N 须为 2 的幂");
+
+    static constexpr std::size_t kMask = N - 1;
+
+    struct Cell {
+        std::atomic<std::size_t> _seq;
+        Uninitialized<T> _val;
+    };
+
+    struct Waiter : AsyncWaiter {
+        EpollLoop *_loop = nullptr; // 等待者所在线程的循环
+        EpollLoop::ResumeNode _resumeNode; // 跨线程唤醒时投递的节点, 不申请内存
+    };
+
+public:
+    Channel() noexcept {
+        for (std::size_t i = 0; i < N; ++i) {
+            _cells[i]._seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    Channel &operator=(Channel &&) = delete;
+
+    ~Channel() {
+        while (tryPop()) // 析构剩下的值
+            ;
+    }
+
+    struct SendAwaiter : Waiter {
+        bool await_ready() {
+            if (_channel._closed.load(std::memory_order_acquire)) {
+                return true;
+            }
+            if (_channel.tryPush(std::move(*_value))) {
+                _value.reset();
+                _channel.notify();
+                return true;
+            }
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> coroutine) {
+            return _channel.suspendSender(*this, coroutine);
+        }
+
+        /**
+         * @return 是否送出 (通道已关闭则为 false)
+         */
+        bool await_resume() noexcept {
+            if (this->_loop) {
+                this->_loop->release();
+            }
+            return !_value;
+        }
+
+        Channel &_channel;
+        std::optional<T> _value; // 送出后清空
+    };
+
+    struct RecvAwaiter : Waiter {
+        bool await_ready() {
+            if ((_value = _channel.tryPop())) {
+                _channel.notify();
+                return true;
+            }
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> coroutine) {
+            return _channel.suspendReceiver(*this, coroutine);
+        }
+
+        /**
+         * @return 收到的值; 通道已关闭且取空则为 std::nullopt
+         */
+        std::optional<T> await_resume() noexcept {
+            if (this->_loop) {
+                this->_loop->release();
+            }
+            return std::move(_value);
+        }
+
+        Channel &_channel;
+        std::optional<T> _value {};
+    };
+
+    /**
+     * @brief `bool ok = co_await ch.send(v);` 满了则挂起
+     */
+    SendAwaiter send(T value) {
+        return {{}, *this, std::move(value)};
+    }
+
+    /**
+     * @brief `std::optional<T> v = co_await ch.recv();` 空了则挂起
+     */
+    RecvAwaiter recv() noexcept {
+        return {{}, *this};
+    }
+
+    /**
+     * @brief 不挂起的发送 (任意线程); 满了或已关闭返回 false, 此时 value 不被移走
+     */
+    template <class U>
+    bool trySend(U &&value) {
+        if (_closed.load(std::memory_order_acquire) || !tryPush(std::forward<U>(value))) {
+            return false;
+        }
+        notify();
+        return true;
+    }
+
+    /**
+     * @brief 不挂起的接收 (任意线程)
+     */
+    std::optional<T> tryRecv() {
+        auto value = tryPop();
+        if (value) {
+            notify();
+        }
+        return value;
+    }
+
+    /**
+     * @brief 关闭通道, 唤醒全部等待者 (任意线程)
+     */
+    void close() {
+        std::lock_guard lock(_mutex);
+        _closed.store(true, std::memory_order_release);
+        serve();
+        for (auto *queue : {&_senders, &_receivers}) {
+            while (auto *waiter = queue->pop()) {
+                _waiting.fetch_sub(1, std::memory_order_relaxed);
+                wake(static_cast<Waiter &>(*waiter));
+            }
+        }
+    }
+
+    bool isClosed() const noexcept {
+        return _closed.load(std::memory_order_acquire);
+    }
+
+private:
+    template <class U>
+    bool tryPush(U &&value) {
+        std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &_cells[pos & kMask];
+            std::size_t seq = cell->_seq.load(std::memory_order_acquire);
+            auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) { // 满
+                return false;
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->_val.putVal(std::forward<U>(value));
+        cell->_seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> tryPop() {
+        std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true) {
+            cell = &_cells[pos & kMask];
+            std::size_t seq = cell->_seq.load(std::memory_order_acquire);
+            auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) { // 空
+                return std::nullopt;
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        std::optional<T> value(cell->_val.moveVal());
+        cell->_seq.store(pos + N, std::memory_order_release);
+        return value;
+    }
+
+    /**
+     * @brief 收发成功之后: 有人在等才加锁替他们完成
+     */
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // 与 suspend* 里登记后的 fence 配对
+        if (_waiting.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(_mutex);
+            serve();
+        }
+    }
+
+    /**
+     * @brief (持锁) 用队列里的值满足等待的接收者, 把等待的发送者的值放进队列, 直到谁都无法前进
+     */
+    void serve() {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            if (auto *waiter = _receivers.pop()) {
+                auto &receiver = static_cast<RecvAwaiter &>(static_cast<Waiter &>(*waiter));
+                if ((receiver._value = tryPop())) {
+                    _waiting.fetch_sub(1, std::memory_order_relaxed);
+                    wake(receiver);
+                    progress = true;
+                } else {
+                    _receivers.pushFront(*waiter);
+                }
+            }
+            if (auto *waiter = _senders.pop()) {
+                auto &sender = static_cast<SendAwaiter &>(static_cast<Waiter &>(*waiter));
+                if (tryPush(std::move(*sender._value))) {
+                    sender._value.reset();
+                    _waiting.fetch_sub(1, std::memory_order_relaxed);
+                    wake(sender);
+                    progress = true;
+                } else {
+                    _senders.pushFront(*waiter);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 登记后再试一次: 与对方 notify 里的 fence 配对, 二者至少有一个能看到对方
+     * @return 是否真的挂起
+     */
+    bool suspendSender(SendAwaiter &sender, std::coroutine_handle<> coroutine) {
+        std::unique_lock lock(_mutex);
+        _waiting.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_closed.load(std::memory_order_relaxed) || tryPush(std::move(*sender._value))) {
+            bool sent = !_closed.load(std::memory_order_relaxed);
+            if (sent) {
+                sender._value.reset();
+            }
+            _waiting.fetch_sub(1, std::memory_order_relaxed);
+            if (sent) {
+                serve(); // 可能有接收者在等
+            }
+            return false;
+        }
+        park(sender, coroutine);
+        _senders.push(sender);
+        return true;
+    }
+
+    bool suspendReceiver(RecvAwaiter &receiver, std::coroutine_handle<> coroutine) {
+        std::unique_lock lock(_mutex);
+        _waiting.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((receiver._value = tryPop()) || _closed.load(std::memory_order_relaxed)) {
+            _waiting.fetch_sub(1, std::memory_order_relaxed);
+            if (receiver._value) {
+                serve(); // 可能有发送者在等
+            }
+            return false;
+        }
+        park(receiver, coroutine);
+        _receivers.push(receiver);
+        return true;
+    }
+
+    static void park(Waiter &waiter, std::coroutine_handle<> coroutine) {
+        waiter._coroutine = coroutine;
+        waiter._resumeNode._coroutine = coroutine;
+        waiter._loop = &EpollLoop::get();
+        waiter._loop->acquire(); // 在等别的线程 post 回来, 循环不能退出
+    }
+
+    static void wake(Waiter &waiter) {
+        waiter._loop->post(waiter._resumeNode); // 之后等待者可能立即被恢复并销毁, 不能再碰它
+    }
+
+    alignas(64) std::atomic<std::size_t> _enqueuePos {0};
+    alignas(64) std::atomic<std::size_t> _dequeuePos {0};
+    alignas(64) std::atomic<std::size_t> _waiting {0}; // 两个等待队列的总人数
+    std::atomic<bool> _closed {false};
+    std::mutex _mutex; // 保护两个等待队列
+    AsyncWaiterQueue _senders;
+    AsyncWaiterQueue _receivers;
+    Cell _cells[N];
+};
+
+} // namespace HX
+
+#endif // !_HX_CHANNEL_H_
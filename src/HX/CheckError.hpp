@@ -0,0 +1,49 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 10:21:05
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_CHECK_ERROR_H_
+#define _HX_CHECK_ERROR_H_
+
+#include <cerrno>
+#include <source_location>
+#include <string>
+#include <system_error>
+
+namespace HX {
+
+/**
+ * @brief 检查系统调用的返回值, 为 -1 则抛出带 errno 与调用位置的 std::system_error
+ */
+auto checkError(
+    auto res, 
+    std::source_location const &loc = std::source_location::current()
+) {
+    if (res == -1) [[unlikely]] {
+        throw std::system_error(
+            errno, 
+            std::system_category(),
+            (std::string)loc.file_name() + ":" + std::to_string(loc.line())
+        );
+    }
+    return res;
+}
+
+} // namespace HX
+
+#endif // !_HX_CHECK_ERROR_H_
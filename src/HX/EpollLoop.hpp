@@ -0,0 +1,519 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 10:24:48
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_EPOLL_LOOP_H_
+#define _HX_EPOLL_LOOP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "Task.hpp"
+#include "TimerLoop.hpp"
+#include "CheckError.hpp"
+
+namespace HX {
+
+/**
+ * @brief Epoll 事件掩码
+ */
+using EpollEventMask = uint32_t;
+
+class EpollLoop {
+    EpollLoop& operator=(EpollLoop&&) = delete;
+
+    explicit EpollLoop() : _epfd(HX::checkError(::epoll_create1(EPOLL_CLOEXEC)))
+                         , _evs()
+    {
+        _evs.resize(64);
+        // 计时器的 timerfd 也挂在 epoll 上, 整个循环只有 epoll_wait 一个等待点
+        struct ::epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = this;
+        HX::checkError(::epoll_ctl(
+            _epfd, EPOLL_CTL_ADD, TimerLoop::getLoop().timerFd(), &event));
+        // 别的线程投递协程后写 eventfd 把 epoll_wait 叫醒
+        _wakeFd = HX::checkError(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        event.data.ptr = &_wakeFd;
+        HX::checkError(::epoll_ctl(_epfd, EPOLL_CTL_ADD, _wakeFd, &event));
+        tlsCurrent = this;
+    }
+
+    ~EpollLoop() {
+        tlsCurrent = nullptr;
+        for (auto *node = takeInbox(); node; ) { // 来不及执行的, 只释放
+            auto *next = node->_next;
+            node->_run(node, false);
+            node = next;
+        }
+        ::close(_wakeFd);
+        ::close(_epfd);
+    }
+
+public:
+    static EpollLoop& get() {
+        static thread_local EpollLoop loop; // 每个线程一个循环
+        return loop;
+    }
+
+    /**
+     * @brief 是否是当前线程的循环 (不会为没有循环的线程创建循环)
+     */
+    bool isCurrent() const noexcept {
+        return tlsCurrent == this;
+    }
+
+    /**
+     * @brief 投递到循环上的一项工作: 侵入式节点, 由别的线程压进收件箱, 在循环线程上执行
+     *
+     * `_run(node, true)` 执行, `_run(node, false)` 表示循环已析构, 只做清理 (堆上的节点释放自己).
+     */
+    struct PostNode {
+        void (*_run)(PostNode *node, bool execute) noexcept = nullptr;
+        PostNode *_next = nullptr;
+    };
+
+    /**
+     * @brief 恢复协程的节点, 嵌在等待者里, 投递时不申请内存
+     */
+    struct ResumeNode : PostNode {
+        ResumeNode() noexcept : PostNode {&ResumeNode::resume} {}
+
+        static void resume(PostNode *node, bool execute) noexcept {
+            if (execute) {
+                TimerLoop::getLoop().addTask(static_cast<ResumeNode *>(node)->_coroutine);
+            }
+        }
+
+        std::coroutine_handle<> _coroutine {};
+    };
+
+    /**
+     * @brief 在本循环所在的线程上恢复 coroutine (线程安全):
+     *        就在本线程则直接放进任务队列, 否则申请一个节点投递过去
+     */
+    void post(std::coroutine_handle<> coroutine) {
+        if (isCurrent()) {
+            TimerLoop::getLoop().addTask(coroutine);
+            return;
+        }
+        post([coroutine] {
+            TimerLoop::getLoop().addTask(coroutine);
+        });
+    }
+
+    /**
+     * @brief 同上, 节点由调用者提供 (在协程恢复之前不能销毁), 不申请内存
+     */
+    void post(ResumeNode &node) noexcept {
+        if (isCurrent()) {
+            TimerLoop::getLoop().addTask(node._coroutine);
+            return;
+        }
+        push(&node);
+    }
+
+    /**
+     * @brief 在本循环所在的线程上调用 func() (线程安全); 总是延后到循环下一次收割事件时执行,
+     *        本线程调用也不会就地执行. func 不应抛异常, 要做异步的事就在里面 addTask 一个协程
+     */
+    template <class F>
+        requires(std::is_invocable_v<std::decay_t<F> &>
+                 && !std::is_convertible_v<F, std::coroutine_handle<>>) // 协程句柄也能调用, 走上面的重载
+    void post(F &&func) {
+        // 节点跨线程申请与释放, 不走线程局部的 FrameAllocator
+        push(new CallableNode<std::decay_t<F>>(std::forward<F>(func)));
+    }
+
+    /**
+     * @brief 等待并处理文件事件
+     * @param timeout 距离下一个计时器的时长; 计时器由 timerfd 唤醒,
+     *                这里只区分为 0 (不等待) 与其他 (一直等到有事件或 timerfd 到期)
+     * @return 没有协程在等文件也没有计时器 (无事可等) 时返回 false
+     */
+    bool run(std::optional<std::chrono::system_clock::duration> timeout);
+
+    bool hasEvent() const noexcept {
+        return _count != 0;
+    }
+
+    /**
+     * @brief 保活: 计一项 "还在等别的线程 post 回来" 的工作, 期间循环不会因为无事可做而退出,
+     *        与 release 成对; 只能在本循环所在的线程上调用
+     */
+    void acquire() noexcept {
+        ++_count;
+    }
+
+    void release() noexcept {
+        --_count;
+    }
+
+    /**
+     * @brief acquire / release 的 RAII 版本: 例如只靠线程池投递工作的循环,
+     *        在 run() 之前建一个, 不再需要投递时销毁
+     */
+    class WorkGuard {
+    public:
+        explicit WorkGuard(EpollLoop &loop = EpollLoop::get()) noexcept : _loop(&loop) {
+            _loop->acquire();
+        }
+
+        WorkGuard &operator=(WorkGuard &&) = delete;
+
+        ~WorkGuard() {
+            _loop->release();
+        }
+
+    private:
+        EpollLoop *_loop;
+    };
+
+    int _epfd = -1;
+private:
+    friend class EpollFdState;
+
+    template <class F>
+    struct CallableNode : PostNode {
+        explicit CallableNode(F func)
+            : PostNode {&CallableNode::invoke}
+            , _func(std::move(func))
+        {}
+
+        static void invoke(PostNode *node, bool execute) noexcept {
+            std::unique_ptr<CallableNode> self(static_cast<CallableNode *>(node));
+            if (execute) {
+                self->_func();
+            }
+        }
+
+        F _func;
+    };
+
+    /**
+     * @brief 压进收件箱 (Treiber 栈, 无锁多生产者); 只有栈由空变非空的那一次才写 eventfd,
+     *        一串连续的投递只唤醒一次
+     */
+    void push(PostNode *node) noexcept {
+        auto *head = _inbox.load(std::memory_order_relaxed);
+        do {
+            node->_next = head;
+        } while (!_inbox.compare_exchange_weak(
+            head, node, std::memory_order_release, std::memory_order_relaxed));
+        if (!head) { // 非空时必有前一个投递者写过 (或即将写) eventfd, 且循环还没把栈取走
+            std::uint64_t one = 1;
+            [[maybe_unused]] auto _ = ::write(_wakeFd, &one, sizeof(one));
+        }
+    }
+
+    /**
+     * @brief 取走整个收件箱, 翻转成投递顺序
+     */
+    PostNode *takeInbox() noexcept {
+        auto *node = _inbox.exchange(nullptr, std::memory_order_acquire);
+        PostNode *fifo = nullptr;
+        while (node) {
+            auto *next = node->_next;
+            node->_next = fifo;
+            fifo = node;
+            node = next;
+        }
+        return fifo;
+    }
+
+    /**
+     * @brief eventfd 可读: 执行收件箱里的全部节点
+     */
+    void drainPosted() {
+        std::uint64_t count;
+        [[maybe_unused]] auto _ = ::read(_wakeFd, &count, sizeof(count)); // 先清 eventfd 再取, 之后的投递必然再写一次
+        auto *node = takeInbox();
+        while (node) {
+            auto *next = node->_next; // 执行后节点可能已被释放
+            node->_run(node, true);
+            node = next;
+        }
+    }
+
+    /**
+     * @brief 本轮还没分发的事件里, 去掉指向 ptr 的 (它在分发前面的事件时被销毁了)
+     */
+    void forget(void *ptr) noexcept {
+        for (int i = _batchPos + 1; i < _batchLen; ++i) {
+            if (_evs[i].data.ptr == ptr) {
+                _evs[i].data.ptr = nullptr;
+            }
+        }
+    }
+
+    std::vector<struct ::epoll_event> _evs;
+    int _batchPos = 0; // 正在分发的事件下标
+    int _batchLen = 0; // 本轮 epoll_wait 收到的事件数, 不在分发时为 0
+    int _count = 0; // 正在等待文件事件 (或等别的线程 post 回来) 的工作数
+    int _wakeFd = -1;
+    std::atomic<PostNode *> _inbox {nullptr}; // 别的线程投递过来的节点 (后进先出的栈)
+
+    static inline thread_local EpollLoop *tlsCurrent = nullptr;
+};
+
+/**
+ * @brief 一个 fd 的注册状态: 构造时以 EPOLLIN | EPOLLOUT | EPOLLET 注册一次, 析构时注销
+ *
+ * 读者和写者各占一个等待槽, 可以同时等待 (全双工);
+ * 边沿触发报告过的就绪位缓存在 `_ready` 里, 读写返回 EAGAIN 后由调用者清掉对应的位,
+ * 所以就绪时的等待不进内核, 未就绪的等待也只是把协程放进槽里.
+ * epoll 的 data.ptr 指向它, 地址在注册期间不能变 (AsyncFile 把它放在堆上).
+ * 只属于注册它的线程的 EpollLoop, 不能跨线程使用.
+ */
+class EpollFdState {
+public:
+    static constexpr EpollEventMask kErrorMask = EPOLLERR | EPOLLHUP;
+    static constexpr EpollEventMask kDefaultEvents = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+
+    /**
+     * @param events 注册的事件 (只注册这一次); 例如共享的监听 socket 用 EPOLLIN | EPOLLET | EPOLLEXCLUSIVE
+     */
+    explicit EpollFdState(int fd, EpollEventMask events = kDefaultEvents) : _fd(fd), _loop(&EpollLoop::get()) {
+        struct ::epoll_event event;
+        event.events = events;
+        event.data.ptr = this;
+        HX::checkError(::epoll_ctl(_loop->_epfd, EPOLL_CTL_ADD, _fd, &event));
+    }
+
+    EpollFdState &operator=(EpollFdState &&) = delete;
+
+    ~EpollFdState() {
+        ::epoll_ctl(_loop->_epfd, EPOLL_CTL_DEL, _fd, nullptr);
+        _loop->forget(this); // EPOLL_CTL_DEL 管不到已经收进 _evs 的事件
+        _loop->_count -= (bool)_reader + (bool)_writer + (bool)_errorWaiter;
+    }
+
+    int getFd() const noexcept {
+        return _fd;
+    }
+
+    /**
+     * @brief 读写返回 EAGAIN 后调用, 表示该方向已经读空/写满;
+     *        同时清掉 EPOLLERR: 读写没报错说明 socket 上没有待报告的错误,
+     *        残留的 EPOLLERR 来自错误队列, 由 waitErrorQueue 单独跟踪
+     */
+    void clearReady(EpollEventMask mask) noexcept {
+        _ready &= ~(mask | EPOLLERR);
+    }
+
+    /**
+     * @brief 开始读错误队列 (recvmsg MSG_ERRQUEUE) 之前调用, 之后到达的条目会再次唤醒 waitErrorQueue
+     */
+    void clearErrorQueue() noexcept {
+        _errorQueued = false;
+    }
+
+    /**
+     * @brief 等待者; 等待者的取消令牌被触发时清空等待槽 (O(1), 不进内核),
+     *        协程放回任务队列由循环恢复, 此时 await_resume 返回 0.
+     *        令牌只能在注册 fd 的线程上触发
+     */
+    struct Awaiter {
+        struct Canceller {
+            void operator()() const noexcept {
+                auto &state = _self->_state;
+                assert(state._loop->isCurrent() && "取消令牌须在等待者所在的线程上触发");
+                auto &slot = _self->slot();
+                if (!slot) { // 事件已先到, 协程已在恢复的路上
+                    return;
+                }
+                TimerLoop::getLoop().addTask(std::exchange(slot, nullptr));
+                --state._loop->_count;
+                _self->_cancelled = true;
+            }
+
+            Awaiter *_self;
+        };
+
+        bool await_ready() const noexcept {
+            return _state._ready & (_mask | kErrorMask);
+        }
+
+        template <class P>
+        bool await_suspend(std::coroutine_handle<P> coroutine) {
+            if constexpr (HasStopToken<P>) {
+                auto const &token = coroutine.promise()._stopToken;
+                if (token.stop_requested()) {
+                    _cancelled = true;
+                    return false;
+                }
+                slot() = coroutine;
+                ++_state._loop->_count;
+                if (token.stop_possible()) {
+                    _stopCallback.emplace(token, Canceller {this});
+                }
+            } else {
+                slot() = coroutine;
+                ++_state._loop->_count;
+            }
+            return true;
+        }
+
+        /**
+         * @return 就绪的事件; 被取消则为 0
+         */
+        EpollEventMask await_resume() const noexcept {
+            if (_cancelled) {
+                return 0;
+            }
+            return _state._ready & (_mask | kErrorMask | EPOLLRDHUP);
+        }
+
+        std::coroutine_handle<> &slot() const noexcept {
+            return _mask & EPOLLIN ? _state._reader : _state._writer;
+        }
+
+        EpollFdState &_state;
+        EpollEventMask _mask;
+        bool _cancelled = false;
+        std::optional<std::stop_callback<Canceller>> _stopCallback {};
+    };
+
+    /**
+     * @brief 等待可读 (或出错/对端关闭)
+     */
+    Awaiter waitReadable() noexcept {
+        return {*this, EPOLLIN | EPOLLRDHUP};
+    }
+
+    /**
+     * @brief 等待可写 (或出错)
+     */
+    Awaiter waitWritable() noexcept {
+        return {*this, EPOLLOUT};
+    }
+
+    /**
+     * @brief 等待错误队列里有新条目 (EPOLLERR), 例如 MSG_ZEROCOPY 的完成通知;
+     *        等的是内核归还页面, 提前返回会让调用方过早复用缓冲区, 所以不响应取消
+     */
+    struct ErrorQueueAwaiter {
+        bool await_ready() const noexcept {
+            return _state._errorQueued;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            _state._errorWaiter = coroutine;
+            ++_state._loop->_count;
+        }
+
+        void await_resume() const noexcept {
+        }
+
+        EpollFdState &_state;
+    };
+
+    ErrorQueueAwaiter waitErrorQueue() noexcept {
+        return {*this};
+    }
+
+private:
+    friend class EpollLoop;
+
+    void onEvent(EpollEventMask events) {
+        _ready |= events;
+        _errorQueued |= (bool)(events & EPOLLERR);
+        // 先把等待槽都取出来: 恢复读者后本对象可能已被析构
+        std::coroutine_handle<> reader, writer, errorWaiter;
+        if (_reader && (events & (EPOLLIN | EPOLLRDHUP | kErrorMask))) {
+            reader = std::exchange(_reader, nullptr);
+            --_loop->_count;
+        }
+        if (_writer && (events & (EPOLLOUT | kErrorMask))) {
+            writer = std::exchange(_writer, nullptr);
+            --_loop->_count;
+        }
+        if (_errorWaiter && (events & EPOLLERR)) {
+            errorWaiter = std::exchange(_errorWaiter, nullptr);
+            --_loop->_count;
+        }
+        if (reader) {
+            reader.resume();
+        }
+        if (writer) {
+            writer.resume();
+        }
+        if (errorWaiter) {
+            errorWaiter.resume();
+        }
+    }
+
+    int _fd;
+    EpollLoop *_loop; // 注册所在线程的循环
+    EpollEventMask _ready = 0;      // 已报告且还没被读空/写满的事件
+    std::coroutine_handle<> _reader; // 等待可读的协程
+    std::coroutine_handle<> _writer; // 等待可写的协程
+    std::coroutine_handle<> _errorWaiter; // 等待错误队列的协程
+    bool _errorQueued = false; // 错误队列里可能有未读的条目
+};
+
+inline bool EpollLoop::run(std::optional<std::chrono::system_clock::duration> timeout) {
+    if (!_count && !timeout)
+        return false;
+    int epollTimeOut = -1;
+    if (timeout && *timeout <= std::chrono::system_clock::duration::zero()) {
+        epollTimeOut = 0; // 已有到期的计时器或待执行的任务, 只收割就绪事件
+    }
+    int len = ::epoll_wait(_epfd, _evs.data(), _evs.size(), epollTimeOut);
+    bool posted = false;
+    _batchLen = std::max(len, 0);
+    for (_batchPos = 0; _batchPos < _batchLen; ++_batchPos) {
+        auto& event = _evs[_batchPos];
+        if (!event.data.ptr) { // 所属的 EpollFdState 已被本轮前面的事件销毁
+            continue;
+        }
+        if (event.data.ptr == this) { // timerfd 到期, 计时器交给 TimerLoop::run
+            TimerLoop::getLoop().clearTimerFd();
+            continue;
+        }
+        if (event.data.ptr == &_wakeFd) { // 收件箱等本轮的文件事件处理完再执行
+            posted = true;
+            continue;
+        }
+        static_cast<EpollFdState *>(event.data.ptr)->onEvent(event.events);
+    }
+    _batchLen = 0;
+    if (posted) {
+        drainPosted();
+    }
+    return true;
+}
+
+} // namespace HX
+
+#endif // !_HX_EPOLL_LOOP_H_
@@ -0,0 +1,196 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-19 09:41:16
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_EXPECTED_H_
+#define _HX_EXPECTED_H_
+
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <expected>
+#include <stop_token>
+#include <system_error>
+#include <utility>
+
+#include "Task.hpp"
+#include "Uninitialized.hpp"
+#include "FrameAllocator.hpp"
+
+namespace HX {
+
+/**
+ * @brief ExpectedPromise 中与结果类型无关的部分: 错误与错误的传递链
+ */
+template <class E>
+struct ExpectedPromiseBase {
+    std::coroutine_handle<> _previous {};         // 上一个协程句柄
+    ExpectedPromiseBase *_propagate = nullptr;    // 通过 try_await 等待本协程的协程: 出错时直接替它结束
+    E _error {};
+    bool _failed = false;
+    std::stop_token _stopToken {};                // 取消令牌, co_await 时从等待者继承
+};
+
+/**
+ * @brief 以 std::expected<T, E> 返回错误的 promise: 没有 exception_ptr, 出错与成功走同一条路径
+ *
+ * `co_return 值;` / `co_return std::unexpected(错误);` (T 为 void 时成功写 `co_return {};`).
+ * 协程体内抛出的异常视为程序错误, 直接 std::terminate.
+ */
+template <class T, class E = std::error_code>
+struct ExpectedPromise : ExpectedPromiseBase<E> {
+    auto initial_suspend() noexcept {
+        return std::suspend_always();
+    }
+
+    /**
+     * @brief 结束: 出错且是被 try_await 等待的, 错误沿链交给等待者,
+     *        直到某个普通 co_await 的协程为止, 中间的协程不再恢复 (帧由各自的 Task 销毁)
+     */
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<ExpectedPromise> coroutine
+        ) const noexcept {
+            ExpectedPromiseBase<E> *promise = &coroutine.promise();
+            while (promise->_failed && promise->_propagate) {
+                auto *parent = promise->_propagate;
+                parent->_error = std::move(promise->_error);
+                parent->_failed = true;
+                promise = parent;
+            }
+            if (promise->_previous) {
+                return promise->_previous;
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        std::terminate();
+    }
+
+    void return_value(std::expected<T, E> &&res) {
+        if (res) [[likely]] {
+            if constexpr (!std::is_void_v<T>) {
+                _value.putVal(std::move(*res));
+            }
+        } else {
+            this->_error = std::move(res.error());
+            this->_failed = true;
+        }
+    }
+
+    std::expected<T, E> result() {
+        if (this->_failed) {
+            return std::unexpected(std::move(this->_error));
+        }
+        if constexpr (std::is_void_v<T>) {
+            return {};
+        } else {
+            return _value.moveVal();
+        }
+    }
+
+    /**
+     * @brief 成功时的值 (try_await 用)
+     */
+    T value() {
+        if constexpr (!std::is_void_v<T>) {
+            return _value.moveVal();
+        }
+    }
+
+    auto get_return_object() {
+        return std::coroutine_handle<ExpectedPromise>::from_promise(*this);
+    }
+
+#if !HX_NO_FRAME_POOL
+    static void *operator new(std::size_t size) {
+        return HX::FrameAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+        HX::FrameAllocator::deallocate(ptr, size);
+    }
+#endif
+
+    ExpectedPromise &operator=(ExpectedPromise &&) = delete;
+
+    Uninitialized<T> _value;
+};
+
+/**
+ * @brief 以 std::expected 返回错误的 Task
+ */
+template <class T, class E = std::error_code>
+using ExpectedTask = Task<std::expected<T, E>, ExpectedPromise<T, E>>;
+
+/**
+ * @brief try_await 的等待者: 成功得到值, 出错则当前协程以同一个错误结束
+ */
+template <class T, class E>
+struct TryAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <class P>
+        requires std::derived_from<P, ExpectedPromiseBase<E>>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> coroutine) const noexcept {
+        auto &promise = _coroutine.promise();
+        promise._previous = coroutine;
+        promise._propagate = &coroutine.promise();
+        if (!promise._stopToken.stop_possible()) {
+            promise._stopToken = coroutine.promise()._stopToken;
+        }
+        return _coroutine;
+    }
+
+    T await_resume() const {
+        return _coroutine.promise().value(); // 能恢复到这里说明子任务成功了
+    }
+
+    ExpectedTask<T, E> _task;
+    std::coroutine_handle<ExpectedPromise<T, E>> _coroutine;
+};
+
+/**
+ * @brief 在 ExpectedTask 中 `auto v = co_await try_await(子任务);`
+ *
+ * 子任务成功得到它的值; 出错时当前协程不再恢复, 直接以同一个错误结束
+ * (像 Rust 的 `?`), 不经过异常. 错误类型须相同.
+ */
+template <class T, class E>
+TryAwaiter<T, E> try_await(ExpectedTask<T, E> task) noexcept {
+    auto coroutine = task.operator co_await()._coroutine;
+    return {std::move(task), coroutine};
+}
+
+} // namespace HX
+
+#endif // !_HX_EXPECTED_H_
@@ -0,0 +1,153 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-15 21:06:12
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_FRAME_ALLOCATOR_H_
+#define _HX_FRAME_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * @brief 定义 `HX_NO_FRAME_POOL` 为 1 则关闭协程帧池, 退回全局 `operator new`
+ */
+#ifndef HX_NO_FRAME_POOL
+#define HX_NO_FRAME_POOL 0
+#endif
+
+namespace HX {
+
+/**
+ * @brief 协程帧分配器: 线程局部的按大小分级空闲链表
+ *
+ * 协程帧大小在编译期就确定了, 同一个协程函数每次调用申请的大小都一样,
+ * 因此释放后的帧直接挂到对应级别的空闲链表上, 下次调用直接复用,
+ * 稳态下 `co_await` 链路不再走 malloc/free.
+ *
+ * 级别为 64, 128, ..., 4096 字节; 超过 4096 的帧直接走全局 `operator new`.
+ * 链表是线程局部的, 因此在 A 线程申请、B 线程释放的帧会留在 B 线程的链表里.
+ */
+class FrameAllocator {
+public:
+    static constexpr std::size_t kMinShift = 6; // 最小级别 64 字节
+    static constexpr std::size_t kClassCount = 7; // 64 ~ 4096 字节
+    static constexpr std::size_t kMaxSize = std::size_t(1) << (kMinShift + kClassCount - 1);
+    static constexpr std::size_t kMaxCached = 1024; // 每个级别最多缓存的帧数
+
+    /**
+     * @brief 分配器计数 (线程局部)
+     */
+    struct Stats {
+        std::uint64_t hits = 0;     // 命中空闲链表
+        std::uint64_t misses = 0;   // 空闲链表为空, 向全局申请
+        std::uint64_t oversize = 0; // 超过最大级别, 直接向全局申请
+        std::uint64_t frees = 0;    // 归还次数
+    };
+
+    static void *allocate(std::size_t size) {
+        Cache &cache = getCache();
+        if (size > kMaxSize) [[unlikely]] {
+            ++cache.stats.oversize;
+            return ::operator new(size);
+        }
+        std::size_t idx = classIndex(size);
+        FreeNode *node = cache.heads[idx];
+        if (node) [[likely]] {
+            cache.heads[idx] = node->next;
+            --cache.counts[idx];
+            ++cache.stats.hits;
+            return node;
+        }
+        ++cache.stats.misses;
+        return ::operator new(classSize(idx));
+    }
+
+    static void deallocate(void *ptr, std::size_t size) noexcept {
+        Cache &cache = getCache();
+        ++cache.stats.frees;
+        if (size > kMaxSize) [[unlikely]] {
+            ::operator delete(ptr);
+            return;
+        }
+        std::size_t idx = classIndex(size);
+        if (cache.counts[idx] >= kMaxCached) [[unlikely]] {
+            ::operator delete(ptr);
+            return;
+        }
+        auto *node = static_cast<FreeNode *>(ptr);
+        node->next = cache.heads[idx];
+        cache.heads[idx] = node;
+        ++cache.counts[idx];
+    }
+
+    /**
+     * @brief 获取当前线程的分配器计数
+     */
+    static Stats const &stats() noexcept {
+        return getCache().stats;
+    }
+
+    /**
+     * @brief 清零当前线程的分配器计数
+     */
+    static void resetStats() noexcept {
+        getCache().stats = {};
+    }
+
+private:
+    struct FreeNode {
+        FreeNode *next;
+    };
+
+    struct Cache {
+        FreeNode *heads[kClassCount] {};
+        std::size_t counts[kClassCount] {};
+        Stats stats {};
+
+        ~Cache() noexcept { // 线程退出时把缓存还给全局
+            for (FreeNode *&head : heads) {
+                while (head) {
+                    FreeNode *next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+            }
+        }
+    };
+
+    static Cache &getCache() noexcept {
+        static thread_local Cache cache;
+        return cache;
+    }
+
+    static constexpr std::size_t classIndex(std::size_t size) noexcept {
+        std::size_t idx = 0;
+        while ((std::size_t(1) << (kMinShift + idx)) < size)
+            ++idx;
+        return idx;
+    }
+
+    static constexpr std::size_t classSize(std::size_t idx) noexcept {
+        return std::size_t(1) << (kMinShift + idx);
+    }
+};
+
+} // namespace HX
+
+#endif // !_HX_FRAME_ALLOCATOR_H_
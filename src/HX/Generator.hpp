@@ -0,0 +1,282 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-18 15:02:09
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_GENERATOR_H_
+#define _HX_GENERATOR_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "FrameAllocator.hpp"
+
+namespace HX {
+
+template <class T>
+class Generator;
+
+/**
+ * @brief `co_yield HX::elements_of(gen)`: 把嵌套生成器的元素逐个交出去
+ */
+template <class T>
+struct ElementsOf {
+    Generator<T> _generator;
+};
+
+template <class T>
+ElementsOf<T> elements_of(Generator<T> generator) noexcept {
+    return {std::move(generator)};
+}
+
+/**
+ * @brief 惰性生成器: 迭代时才运行协程, 每次 co_yield 交出一个元素
+ *
+ * 迭代器解引用得到的是 co_yield 的那个对象本身 (只保存它的地址, 不拷贝),
+ * 它在协程帧里活到下一次 ++ 为止; 调用者可以直接把它移走.
+ * (只有 co_yield 一个 const 左值时才拷贝一份, 放在挂起点的等待者里)
+ *
+ * 嵌套: `co_yield elements_of(子生成器)`; 最外层的 promise 记录当前最内层的协程,
+ * ++ 直接恢复它, 子生成器结束时对称转移回父生成器, 所以每个元素都是 O(1), 与嵌套深度无关.
+ * 子生成器的异常在父生成器的 co_yield 处重新抛出, 最外层的异常从 ++ (或 begin) 抛出.
+ * @tparam T 元素类型
+ */
+template <class T>
+class [[nodiscard]] Generator {
+    static_assert(!std::is_reference_v<T>, "Generator<T>: T 必须是对象类型");
+
+public:
+    struct promise_type {
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            /**
+             * @brief 子生成器结束: 转回父生成器; 最外层结束: 回到迭代器
+             */
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> coroutine
+            ) const noexcept {
+                auto &promise = coroutine.promise();
+                if (promise._parent) {
+                    promise._root->_leaf = promise._parent;
+                    return promise._parent;
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept {
+            return {};
+        }
+
+        void unhandled_exception() noexcept {
+            _exception = std::current_exception();
+        }
+
+        void return_void() noexcept {}
+
+        std::suspend_always yield_value(T &value) noexcept {
+            _root->_value = std::addressof(value);
+            return {};
+        }
+
+        std::suspend_always yield_value(T &&value) noexcept {
+            _root->_value = std::addressof(value); // 临时对象活到协程恢复
+            return {};
+        }
+
+        /**
+         * @brief const 左值不能交出可修改的引用, 拷一份放在等待者里
+         */
+        struct CopyAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept {
+                coroutine.promise()._root->_value = std::addressof(_copy);
+            }
+
+            void await_resume() const noexcept {}
+
+            T _copy;
+        };
+
+        CopyAwaiter yield_value(T const &value) requires std::is_copy_constructible_v<T> {
+            return {value};
+        }
+
+        struct NestedAwaiter {
+            bool await_ready() const noexcept {
+                return !_generator._coroutine;
+            }
+
+            /**
+             * @brief 挂上子生成器并直接转过去运行
+             */
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> coroutine
+            ) noexcept {
+                auto child = _generator._coroutine;
+                auto &promise = child.promise();
+                promise._root = coroutine.promise()._root;
+                promise._parent = coroutine;
+                promise._root->_leaf = child;
+                return child;
+            }
+
+            void await_resume() const {
+                if (_generator._coroutine && _generator._coroutine.promise()._exception) {
+                    std::rethrow_exception(_generator._coroutine.promise()._exception);
+                }
+            }
+
+            Generator _generator;
+        };
+
+        NestedAwaiter yield_value(ElementsOf<T> nested) noexcept {
+            return {std::move(nested._generator)};
+        }
+
+        template <class U>
+        void await_transform(U &&) = delete; // 同步生成器里不能 co_await
+
+        Generator get_return_object() noexcept {
+            return Generator {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+#if !HX_NO_FRAME_POOL
+        static void *operator new(std::size_t size) {
+            return HX::FrameAllocator::allocate(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept {
+            HX::FrameAllocator::deallocate(ptr, size);
+        }
+#endif
+
+        promise_type &operator=(promise_type &&) = delete;
+
+        T *_value = nullptr;                           // 当前元素 (只在最外层的 promise 上有效)
+        promise_type *_root = this;                    // 最外层的 promise
+        std::coroutine_handle<promise_type> _parent;   // 父生成器, 最外层为空
+        std::coroutine_handle<promise_type> _leaf =    // 当前最内层的协程 (只在最外层上有效)
+            std::coroutine_handle<promise_type>::from_promise(*this);
+        std::exception_ptr _exception {};
+    };
+
+    class iterator {
+    public:
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        explicit iterator(std::coroutine_handle<promise_type> coroutine) noexcept
+            : _coroutine(coroutine)
+        {}
+
+        T &operator*() const noexcept {
+            return *_coroutine.promise()._value;
+        }
+
+        T *operator->() const noexcept {
+            return _coroutine.promise()._value;
+        }
+
+        iterator &operator++() {
+            resume(_coroutine);
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept {
+            return !_coroutine || _coroutine.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> _coroutine {};
+    };
+
+    Generator() noexcept = default;
+
+    explicit Generator(std::coroutine_handle<promise_type> coroutine) noexcept
+        : _coroutine(coroutine)
+    {}
+
+    Generator(Generator &&that) noexcept : _coroutine(that._coroutine) {
+        that._coroutine = nullptr;
+    }
+
+    Generator &operator=(Generator &&that) noexcept {
+        std::swap(_coroutine, that._coroutine);
+        return *this;
+    }
+
+    ~Generator() {
+        if (_coroutine)
+            _coroutine.destroy(); // 连同挂在帧里的子生成器一起销毁
+    }
+
+    /**
+     * @brief 开始运行到第一个元素; 只能调用一次 (输入范围)
+     */
+    iterator begin() {
+        if (_coroutine) {
+            resume(_coroutine);
+        }
+        return iterator {_coroutine};
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return {};
+    }
+
+private:
+    /**
+     * @brief 恢复最内层的协程, 直到它交出下一个元素或最外层结束
+     */
+    static void resume(std::coroutine_handle<promise_type> root) {
+        auto &promise = root.promise();
+        promise._leaf.resume();
+        if (promise._exception) [[unlikely]] {
+            std::rethrow_exception(std::exchange(promise._exception, nullptr));
+        }
+    }
+
+    std::coroutine_handle<promise_type> _coroutine {};
+};
+
+} // namespace HX
+
+#endif // !_HX_GENERATOR_H_
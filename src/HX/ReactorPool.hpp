@@ -0,0 +1,245 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 19:25:48
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_REACTOR_POOL_H_
+#define _HX_REACTOR_POOL_H_
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "Task.hpp"
+#include "TimerLoop.hpp"
+#include "EpollLoop.hpp"
+#include "AsyncLoop.hpp"
+#include "AsyncFile.hpp"
+#include "AsyncListener.hpp"
+#include "CheckError.hpp"
+
+namespace HX {
+
+/**
+ * @brief 多反应堆 (thread-per-core): N 个线程, 每个线程跑自己的 AsyncLoop
+ *
+ * 各线程的 TimerLoop/EpollLoop/UringLoop 互不共享, 协程在哪个反应堆上开始就一直在那里运行.
+ * 跨线程只有一个入口: 目标反应堆的 EpollLoop::post (无锁收件箱 + eventfd 唤醒).
+ * 析构 (或 stop()) 时各反应堆在当前一轮结束后退出, 还挂着的协程不会被恢复.
+ */
+class ReactorPool {
+    struct Reactor {
+        std::thread _thread;
+        EpollLoop *_epollLoop = nullptr; // 反应堆线程上的循环, 启动后由它自己填入
+        AsyncLoop *_loop = nullptr;
+    };
+
+public:
+    /**
+     * @param n 反应堆个数
+     * @param pinCores 是否把第 i 个反应堆绑定到第 i 个核上
+     */
+    explicit ReactorPool(
+        std::size_t n = std::thread::hardware_concurrency(),
+        bool pinCores = true
+    ) {
+        n = n ? n : 1;
+        _reactors.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            _reactors.push_back(std::make_unique<Reactor>());
+        }
+        unsigned cores = std::thread::hardware_concurrency();
+        std::latch ready((std::ptrdiff_t)n);
+        for (std::size_t i = 0; i < n; ++i) {
+            int cpu = pinCores && cores ? (int)(i % cores) : -1;
+            _reactors[i]->_thread = std::thread(
+                &ReactorPool::runReactor, std::ref(*_reactors[i]), cpu, std::ref(ready));
+        }
+        ready.wait(); // 各反应堆的循环都建好了才能往里投递
+    }
+
+    ReactorPool &operator=(ReactorPool &&) = delete;
+
+    ~ReactorPool() {
+        stop();
+    }
+
+    std::size_t size() const noexcept {
+        return _reactors.size();
+    }
+
+    /**
+     * @brief 在第 idx 个反应堆上恢复 coroutine (线程安全)
+     */
+    void post(std::size_t idx, std::coroutine_handle<> coroutine) {
+        _reactors[idx % _reactors.size()]->_epollLoop->post(coroutine);
+    }
+
+    /**
+     * @brief 在第 idx 个反应堆上运行 task, 跑完自行销毁; 它抛出的异常见 serve()
+     */
+    void spawn(std::size_t idx, Task<void> task) {
+        post(idx, serve(std::move(task))._coroutine);
+    }
+
+    /**
+     * @brief 把一个已连接的 file 交给第 idx 个反应堆, 在那边调用 handler(AsyncFile) 并运行它返回的 Task<void>
+     */
+    template <class Handler>
+    void spawn(std::size_t idx, AsyncFile file, Handler handler) {
+        post(idx, serve(adopt(file.release(), std::move(handler)))._coroutine);
+    }
+
+    /**
+     * @brief 在每个反应堆上监听 ip:port, 连接在接受它的反应堆上交给 handler(AsyncFile) 处理
+     *        (绑定失败在调用线程抛 std::system_error)
+     * @param options 默认每个反应堆各开一个 SO_REUSEPORT 的监听 socket, 由内核把连接分给各反应堆;
+     *        exclusive 为 true 时只开一个, 各反应堆以 EPOLLEXCLUSIVE 共同等待它
+     */
+    template <class Handler>
+    void listen(const char *ip, int port, Handler handler, ListenerOptions options = {}) {
+        options.reusePort |= !options.exclusive;
+        std::vector<int> fds;
+        try {
+            for (std::size_t i = 0; i < _reactors.size(); ++i) {
+                if (options.exclusive && i) { // 共享同一个监听 socket, 各自持有一份 dup 的 fd
+                    fds.push_back(HX::checkError(::fcntl(fds[0], F_DUPFD_CLOEXEC, 0)));
+                } else {
+                    fds.push_back(createTcpListenSocketV4(ip, port, options.reusePort, options.backlog));
+                }
+            }
+        } catch (...) {
+            for (int fd : fds) {
+                ::close(fd);
+            }
+            throw;
+        }
+        for (std::size_t i = 0; i < fds.size(); ++i) {
+            post(i, acceptLoop(fds[i], handler, options)._coroutine);
+        }
+    }
+
+    /**
+     * @brief 让全部反应堆退出并等待线程结束 (可重复调用)
+     */
+    void stop() {
+        for (auto &reactor : _reactors) {
+            if (reactor->_thread.joinable()) {
+                reactor->_epollLoop->post([loop = reactor->_loop] {
+                    loop->stop();
+                });
+            }
+        }
+        for (auto &reactor : _reactors) {
+            if (reactor->_thread.joinable()) {
+                reactor->_thread.join();
+            }
+        }
+    }
+
+private:
+    static void runReactor(Reactor &reactor, int cpu, std::latch &ready) {
+        if (cpu >= 0) {
+            ::cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+        }
+        ::sigset_t pipe;
+        ::sigemptyset(&pipe);
+        ::sigaddset(&pipe, SIGPIPE);
+        ::pthread_sigmask(SIG_BLOCK, &pipe, nullptr); // 往已关闭的连接上写只返回 EPIPE, 不杀进程
+        AsyncLoop loop;
+        auto &epollLoop = EpollLoop::get();
+        EpollLoop::WorkGuard guard(epollLoop); // 一直在等别的线程投递, 没有别的事也不退出, 直到 stop()
+        reactor._epollLoop = &epollLoop;
+        reactor._loop = &loop;
+        ready.count_down();
+        loop.run();
+    }
+
+    /**
+     * @brief 分离地运行 task: 连接上的错误 (对端重置、EPIPE、被取消...) 以 std::system_error 抛出,
+     *        只结束这一个连接, 直接丢掉; 其它异常打到 stderr. 都不会逃出 DetachedTask 去 std::terminate
+     */
+    static DetachedTask serve(Task<void> task) {
+        try {
+            co_await task;
+        } catch (std::system_error const &) {
+        } catch (std::exception const &e) {
+            std::cerr << "HX::ReactorPool: " << e.what() << '\n';
+        }
+    }
+
+    /**
+     * @brief 在当前线程上 (恢复时) 接管 fd (已是非阻塞的) 并运行 handler
+     */
+    template <class Handler>
+    static Task<void> adopt(int fd, Handler handler) {
+        co_await handler(AsyncFile(fd, true));
+    }
+
+    /**
+     * @brief 在当前线程上接管监听 socket, 每接受一个连接就分离地运行 handler(AsyncFile);
+     *        资源暂时耗尽时歇一会儿再继续, 其余错误结束监听.
+     *        接管要在反应堆线程上做 (注册到它的循环), 失败时关闭 fd, 这个反应堆不再监听
+     *        (异常不能逃出 DetachedTask, 否则 std::terminate)
+     */
+    template <class Handler>
+    static DetachedTask acceptLoop(int fd, Handler handler, ListenerOptions options) {
+        std::optional<AsyncListener> listener;
+        try {
+            listener.emplace(fd, options);
+        } catch (...) { // 构造失败时 fd 已被关闭
+            co_return;
+        }
+        while (true) {
+            int error = 0;
+            AsyncFile file;
+            try {
+                file = co_await listener->accept();
+            } catch (std::system_error const &e) {
+                error = e.code().value();
+            }
+            if (!error) {
+                TimerLoop::getLoop().addTask(serve(handler(std::move(file)))._coroutine);
+            } else if (error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM) {
+                co_await TimerLoop::sleep_for(std::chrono::milliseconds(10));
+            } else {
+                co_return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Reactor>> _reactors;
+};
+
+} // namespace HX
+
+#endif // !_HX_REACTOR_POOL_H_
@@ -0,0 +1,102 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-17 14:06:51
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_RETURN_PREVIOUS_TASK_H_
+#define _HX_RETURN_PREVIOUS_TASK_H_
+
+#include <coroutine>
+#include <exception>
+#include <stop_token>
+
+#include "FrameAllocator.hpp"
+#include "PreviousAwaiter.hpp"
+
+namespace HX {
+
+/**
+ * @brief 结束时转移到 co_return 给出的协程的 Promise (给 nullptr 则什么也不恢复)
+ *
+ * 用于组合子的辅助协程: 由它自己决定结束后是否恢复等待者, 而不是固定恢复 _previous.
+ */
+struct ReturnPreviousPromise {
+    auto initial_suspend() noexcept {
+        return std::suspend_always();
+    }
+
+    auto final_suspend() noexcept {
+        return HX::PreviousAwaiter(_previous);
+    }
+
+    void unhandled_exception() noexcept {
+        std::terminate(); // 辅助协程自己捕获子任务的异常, 不会走到这里
+    }
+
+    void return_value(std::coroutine_handle<> previous) noexcept {
+        _previous = previous;
+    }
+
+    auto get_return_object() {
+        return std::coroutine_handle<ReturnPreviousPromise>::from_promise(*this);
+    }
+
+#if !HX_NO_FRAME_POOL
+    static void *operator new(std::size_t size) {
+        return HX::FrameAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+        HX::FrameAllocator::deallocate(ptr, size);
+    }
+#endif
+
+    ReturnPreviousPromise &operator=(ReturnPreviousPromise &&) = delete;
+
+    std::coroutine_handle<> _previous {};
+    std::stop_token _stopToken {}; // 传给 co_await 的子任务
+};
+
+/**
+ * @brief 持有一个 ReturnPreviousPromise 协程, 析构时销毁它
+ */
+struct [[nodiscard]] ReturnPreviousTask {
+    using promise_type = ReturnPreviousPromise;
+
+    ReturnPreviousTask(std::coroutine_handle<promise_type> coroutine) noexcept
+        : _coroutine(coroutine) {}
+
+    ReturnPreviousTask(ReturnPreviousTask &&that) noexcept : _coroutine(that._coroutine) {
+        that._coroutine = nullptr;
+    }
+
+    ReturnPreviousTask &operator=(ReturnPreviousTask &&that) noexcept {
+        std::swap(_coroutine, that._coroutine);
+        return *this;
+    }
+
+    ~ReturnPreviousTask() {
+        if (_coroutine)
+            _coroutine.destroy();
+    }
+
+    std::coroutine_handle<promise_type> _coroutine;
+};
+
+} // namespace HX
+
+#endif // !_HX_RETURN_PREVIOUS_TASK_H_
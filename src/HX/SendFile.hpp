@@ -0,0 +1,147 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 18:12:47
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_SEND_FILE_H_
+#define _HX_SEND_FILE_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+#include "Task.hpp"
+#include "AsyncFile.hpp"
+#include "CheckError.hpp"
+
+namespace HX {
+
+inline constexpr std::size_t kSpliceMaxLen = 0x7ffff000; // 单次 sendfile/splice 的上限 (同 read/write)
+
+/**
+ * @brief 零拷贝地把文件 [offset, offset + count) 发到 sock 上 (sendfile): 数据不经过用户态,
+ *        socket 写满 (EAGAIN) 时挂起等可写, 直到发完或读到文件末尾.
+ *        出错 (包括被取消) 抛 std::system_error
+ * @param fileFd 普通文件 (支持 mmap 的), 阻塞与否都行; 不改变它的文件偏移
+ * @return 发送的字节数 (文件不够长时小于 count)
+ */
+inline HX::Task<std::size_t> sendFile(AsyncFile &sock, int fileFd, off_t offset, std::size_t count) {
+    std::size_t total = 0;
+    while (total < count) {
+        ssize_t len = ::sendfile(sock.getFd(), fileFd, &offset,
+                                 std::min(count - total, kSpliceMaxLen));
+        if (len > 0) {
+            total += (std::size_t)len;
+        } else if (len == 0) { // 文件到头了
+            break;
+        } else if (errno == EAGAIN) {
+            if (!co_await sock.waitWritable()) { // 被取消
+                errno = ECANCELED;
+                HX::checkError(-1);
+            }
+        } else if (errno != EINTR) {
+            HX::checkError(len);
+        }
+    }
+    co_return total;
+}
+
+/**
+ * @brief splice 用的管道对 (非阻塞); 析构时关闭
+ */
+class SplicePipe {
+public:
+    SplicePipe() {
+        HX::checkError(::pipe2(_fds, O_NONBLOCK | O_CLOEXEC));
+    }
+
+    SplicePipe &operator=(SplicePipe &&) = delete;
+
+    ~SplicePipe() {
+        ::close(_fds[0]);
+        ::close(_fds[1]);
+    }
+
+    int readFd() const noexcept {
+        return _fds[0];
+    }
+
+    int writeFd() const noexcept {
+        return _fds[1];
+    }
+
+private:
+    int _fds[2];
+};
+
+/**
+ * @brief 把 from 上收到的数据原样转发到 to (socket 到 socket, 经由管道 splice, 不经过用户态),
+ *        直到 from 读到 EOF 或转发满 count 字节. 每次把管道里的全部搬空再去读,
+ *        所以管道本身不会阻塞, 只在两端 socket 上 EAGAIN 时挂起.
+ *        出错 (包括被取消) 抛 std::system_error
+ * @return 转发的字节数
+ */
+inline HX::Task<std::size_t> spliceForward(
+    AsyncFile &from, AsyncFile &to,
+    std::size_t count = std::numeric_limits<std::size_t>::max()
+) {
+    SplicePipe pipe;
+    std::size_t total = 0;
+    while (total < count) {
+        ssize_t got = ::splice(from.getFd(), nullptr, pipe.writeFd(), nullptr,
+                               std::min(count - total, kSpliceMaxLen),
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (got == 0) { // 对端关闭
+            break;
+        }
+        if (got < 0) {
+            if (errno == EAGAIN) {
+                if (!co_await from.waitReadable()) { // 被取消
+                    errno = ECANCELED;
+                    HX::checkError(-1);
+                }
+            } else if (errno != EINTR) {
+                HX::checkError(got);
+            }
+            continue;
+        }
+        for (std::size_t left = (std::size_t)got; left; ) { // 搬空管道
+            ssize_t put = ::splice(pipe.readFd(), nullptr, to.getFd(), nullptr, left,
+                                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (put > 0) {
+                left -= (std::size_t)put;
+            } else if (put == -1 && errno == EAGAIN) {
+                if (!co_await to.waitWritable()) { // 被取消
+                    errno = ECANCELED;
+                    HX::checkError(-1);
+                }
+            } else if (put == -1 && errno != EINTR) {
+                HX::checkError(put);
+            }
+        }
+        total += (std::size_t)got;
+    }
+    co_return total;
+}
+
+} // namespace HX
+
+#endif // !_HX_SEND_FILE_H_
@@ -0,0 +1,218 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-21 16:05:44
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_SHARED_TASK_H_
+#define _HX_SHARED_TASK_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "Task.hpp"
+#include "AsyncSync.hpp"
+#include "FrameAllocator.hpp"
+
+namespace HX {
+
+/**
+ * @brief SharedTask 的 Promise: 结果缓存在帧里, 等待者挂在侵入式队列上
+ *
+ * 引用计数由 SharedTask 的副本持有, 只在当前线程上使用, 不需要原子操作.
+ * 没有取消令牌: 一个等待者被取消不应影响其他等待者共享的那份工作.
+ */
+struct SharedPromiseBase {
+    auto initial_suspend() noexcept {
+        return std::suspend_always(); // 第一个等待者来了才开始
+    }
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        /**
+         * @brief 第一个等待者对称转移过去, 其余放进任务队列, 由循环恢复
+         */
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<>) const noexcept {
+            _promise._done = true;
+            auto *first = _promise._waiters.pop();
+            _promise._waiters.resumeAll();
+            return first ? first->_coroutine : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+
+        SharedPromiseBase &_promise;
+    };
+
+    FinalAwaiter final_suspend() noexcept {
+        return {*this};
+    }
+
+    void unhandled_exception() noexcept {
+        _exception = std::current_exception();
+    }
+
+#if !HX_NO_FRAME_POOL
+    static void *operator new(std::size_t size) {
+        return HX::FrameAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+        HX::FrameAllocator::deallocate(ptr, size);
+    }
+#endif
+
+    SharedPromiseBase &operator=(SharedPromiseBase &&) = delete;
+
+    std::size_t _refs = 1;         // SharedTask 的副本数
+    bool _started = false;         // 是否已被第一个等待者启动
+    bool _done = false;            // 是否已结束 (结果可读)
+    AsyncWaiterQueue _waiters;     // 等它结束的协程
+    std::exception_ptr _exception; // 异常, 每个等待者都会重新抛出
+};
+
+template <class T>
+struct SharedPromise : SharedPromiseBase {
+    template <class U = T>
+        requires std::is_constructible_v<T, U &&>
+    void return_value(U &&res) {
+        _value.emplace(std::forward<U>(res));
+    }
+
+    T const &result() const {
+        if (_exception) [[unlikely]] {
+            std::rethrow_exception(_exception);
+        }
+        return *_value;
+    }
+
+    auto get_return_object() {
+        return std::coroutine_handle<SharedPromise>::from_promise(*this);
+    }
+
+    std::optional<T> _value; // 结果 (随帧一起析构)
+};
+
+template <>
+struct SharedPromise<void> : SharedPromiseBase {
+    void return_void() noexcept {
+    }
+
+    void result() const {
+        if (_exception) [[unlikely]] {
+            std::rethrow_exception(_exception);
+        }
+    }
+
+    auto get_return_object() {
+        return std::coroutine_handle<SharedPromise>::from_promise(*this);
+    }
+};
+
+/**
+ * @brief 可以被多个协程同时等待的任务: 只运行一次, 结果缓存起来, 以 const 引用交给每个等待者
+ *
+ * Task 的 Awaiter 会覆盖 `_previous`, 只能有一个等待者; SharedTask 把等待者挂进侵入式队列
+ * (节点在等待者的协程帧里, 不申请内存), 第一个等待者启动它, 结束时全部恢复
+ * (第一个对称转移过去, 其余在本轮由循环恢复). 之后再等待直接拿到缓存的结果或重新抛出异常.
+ * 用于合并相同的请求 (同一个域名、同一个上游资源只查一次).
+ *
+ * 可以复制, 最后一个副本析构时销毁协程帧; 返回的引用在还有副本时有效
+ * (`co_await` 临时的 SharedTask 时, 请在表达式结束前拷贝结果).
+ * 只在当前线程上使用; 等待中的协程不能被销毁.
+ * @tparam T 返回值类型
+ */
+template <class T = void>
+class [[nodiscard]] SharedTask {
+public:
+    using promise_type = SharedPromise<T>;
+
+    SharedTask(std::coroutine_handle<promise_type> coroutine = nullptr) noexcept
+        : _coroutine(coroutine) {}
+
+    SharedTask(SharedTask const &that) noexcept : _coroutine(that._coroutine) {
+        if (_coroutine) {
+            ++_coroutine.promise()._refs;
+        }
+    }
+
+    SharedTask(SharedTask &&that) noexcept : _coroutine(std::exchange(that._coroutine, nullptr)) {}
+
+    SharedTask &operator=(SharedTask that) noexcept {
+        std::swap(_coroutine, that._coroutine);
+        return *this;
+    }
+
+    ~SharedTask() {
+        if (_coroutine && --_coroutine.promise()._refs == 0) {
+            _coroutine.destroy();
+        }
+    }
+
+    struct Awaiter : AsyncWaiter {
+        bool await_ready() const noexcept {
+            return _promise._done;
+        }
+
+        /**
+         * @brief 挂进等待队列; 还没开始则由本等待者启动它
+         */
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            _coroutine = coroutine;
+            _promise._waiters.push(*this);
+            if (!_promise._started) {
+                _promise._started = true;
+                return std::coroutine_handle<promise_type>::from_promise(_promise);
+            }
+            return std::noop_coroutine();
+        }
+
+        decltype(auto) await_resume() const {
+            return _promise.result();
+        }
+
+        promise_type &_promise;
+    };
+
+    Awaiter operator co_await() const noexcept {
+        return {{}, _coroutine.promise()};
+    }
+
+    /**
+     * @brief 是否已结束 (此后 co_await 不会挂起)
+     */
+    bool isDone() const noexcept {
+        return _coroutine.promise()._done;
+    }
+
+    explicit operator bool() const noexcept {
+        return (bool)_coroutine;
+    }
+
+private:
+    std::coroutine_handle<promise_type> _coroutine;
+};
+
+} // namespace HX
+
+#endif // !_HX_SHARED_TASK_H_
@@ -0,0 +1,327 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-17 09:48:05
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_STEALING_EXECUTOR_H_
+#define _HX_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Task.hpp"
+
+namespace HX {
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列 (Lê 等人的 C11 内存序版本)
+ *
+ * 只有所属线程 push/pop (在底部, LIFO, 缓存热), 其他线程从顶部 steal (FIFO, 偷走最老的大块任务).
+ * 满了就扩容为两倍; 旧数组可能还在被窃取者读, 留到析构时再释放.
+ * @tparam T 可以放进 std::atomic 的平凡类型 (这里是协程句柄的地址)
+ */
+template <class T>
+class ChaseLevDeque {
+    struct Array {
+        explicit Array(std::int64_t capacity)
+            : _capacity(capacity)
+            , _buf(std::make_unique<std::atomic<T>[]>((std::size_t)capacity))
+        {}
+
+        T get(std::int64_t i) const noexcept {
+            return _buf[(std::size_t)(i & (_capacity - 1))].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T value) noexcept {
+            _buf[(std::size_t)(i & (_capacity - 1))].store(value, std::memory_order_relaxed);
+        }
+
+        std::int64_t _capacity; // 2 的幂
+        std::unique_ptr<std::atomic<T>[]> _buf;
+    };
+
+public:
+    explicit ChaseLevDeque(std::int64_t capacity = 256) {
+        _arrays.push_back(std::make_unique<Array>(capacity));
+        _array.store(_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque &operator=(ChaseLevDeque &&) = delete;
+
+    /**
+     * @brief 压入底部 (仅所属线程)
+     */
+    void push(T value) {
+        std::int64_t b = _bottom.load(std::memory_order_relaxed);
+        std::int64_t t = _top.load(std::memory_order_acquire);
+        Array *a = _array.load(std::memory_order_relaxed);
+        if (b - t > a->_capacity - 1) { // 满了, 扩容
+            auto bigger = std::make_unique<Array>(a->_capacity * 2);
+            for (std::int64_t i = t; i < b; ++i) {
+                bigger->put(i, a->get(i));
+            }
+            a = bigger.get();
+            _arrays.push_back(std::move(bigger));
+            _array.store(a, std::memory_order_release);
+        }
+        a->put(b, value);
+        _bottom.store(b + 1, std::memory_order_release); // 与 steal 读 _bottom 配对, 发布元素
+    }
+
+    /**
+     * @brief 从底部弹出 (仅所属线程)
+     * @return 是否弹出
+     */
+    bool pop(T &value) {
+        std::int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = _array.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = _top.load(std::memory_order_relaxed);
+        if (t > b) { // 空
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        value = a->get(b);
+        if (t == b) { // 最后一个: 与窃取者竞争
+            bool won = _top.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 从顶部窃取 (任意线程)
+     * @return 是否窃取到; 与别人竞争失败也返回 false
+     */
+    bool steal(T &value) {
+        std::int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Array *a = _array.load(std::memory_order_acquire);
+        value = a->get(t);
+        return _top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    bool empty() const noexcept {
+        return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<std::int64_t> _top {0};    // 窃取者争用
+    alignas(64) std::atomic<std::int64_t> _bottom {0}; // 所属线程独占
+    std::atomic<Array *> _array;
+    std::vector<std::unique_ptr<Array>> _arrays; // 全部用过的数组, 析构时释放
+};
+
+/**
+ * @brief 工作窃取线程池: 每个工作线程一个 Chase-Lev 队列, 外部线程提交的任务进全局注入队列
+ *
+ * `co_await executor.schedule()` 把当前协程挪到池里继续运行;
+ * 之后 co_await 子 Task 仍走 Task::Awaiter 的对称转移, 在同一工作线程上内联执行,
+ * 子任务结束时 PreviousAwaiter 直接转回父协程, 不经过队列.
+ * 工作线程上提交的任务压进自己的队列底部, 空闲的线程从别人的队列顶部窃取.
+ * 析构时等线程退出, 队列中还没运行的协程不会被恢复.
+ */
+class StealingExecutor {
+    struct Worker {
+        ChaseLevDeque<void *> _deque;
+        std::thread _thread;
+    };
+
+public:
+    explicit StealingExecutor(std::size_t n = std::thread::hardware_concurrency()) {
+        n = n ? n : 1;
+        for (std::size_t i = 0; i < n; ++i) {
+            _workers.push_back(std::make_unique<Worker>());
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            _workers[i]->_thread = std::thread(&StealingExecutor::workerMain, this, i);
+        }
+    }
+
+    StealingExecutor &operator=(StealingExecutor &&) = delete;
+
+    ~StealingExecutor() {
+        _stopping.store(true, std::memory_order_seq_cst);
+        _epoch.fetch_add(1, std::memory_order_seq_cst);
+        _epoch.notify_all();
+        for (auto &worker : _workers) {
+            worker->_thread.join();
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return _workers.size();
+    }
+
+    /**
+     * @brief 在池中恢复 coroutine (线程安全):
+     *        在本池的工作线程上调用则压进自己的队列, 否则进全局注入队列
+     */
+    void post(std::coroutine_handle<> coroutine) {
+        if (tlsExecutor == this) {
+            _workers[tlsIndex]->_deque.push(coroutine.address());
+        } else {
+            std::lock_guard lock(_injectMutex);
+            _inject.push_back(coroutine.address());
+            _injectSize.store(_inject.size(), std::memory_order_relaxed);
+        }
+        wakeOne();
+    }
+
+    /**
+     * @brief 在池中运行 task, 跑完自行销毁
+     */
+    void spawn(Task<void> task) {
+        post(detach(std::move(task))._coroutine);
+    }
+
+    struct ScheduleAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) {
+            _executor.post(coroutine); // 之后可能立刻被别的线程恢复, 不能再碰 this
+        }
+
+        void await_resume() const noexcept {
+        }
+
+        StealingExecutor &_executor;
+    };
+
+    /**
+     * @brief `co_await executor.schedule()`: 挂起当前协程, 在池中的某个工作线程上继续
+     */
+    ScheduleAwaiter schedule() noexcept {
+        return {*this};
+    }
+
+    /**
+     * @brief 当前线程所属的池, 不是工作线程则为 nullptr
+     */
+    static StealingExecutor *current() noexcept {
+        return tlsExecutor;
+    }
+
+private:
+    void wakeOne() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // 与 workerMain 的 _sleepers++ 配对
+        if (_sleepers.load(std::memory_order_seq_cst)) {
+            _epoch.fetch_add(1, std::memory_order_release);
+            _epoch.notify_one();
+        }
+    }
+
+    bool popInject(void *&value) {
+        if (!_injectSize.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        std::lock_guard lock(_injectMutex);
+        if (_inject.empty()) {
+            return false;
+        }
+        value = _inject.front();
+        _inject.pop_front();
+        _injectSize.store(_inject.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief 找活干: 自己的队列 -> 全局注入队列 -> 从其他线程窃取
+     */
+    bool findWork(std::size_t self, std::uint64_t &seed, void *&value) {
+        if (_workers[self]->_deque.pop(value) || popInject(value)) {
+            return true;
+        }
+        std::size_t n = _workers.size();
+        seed ^= seed << 13; // xorshift 选起点, 避免所有线程盯着同一个受害者
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        std::size_t start = (std::size_t)(seed % n);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t victim = (start + i) % n;
+            if (victim != self && _workers[victim]->_deque.steal(value)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerMain(std::size_t self) {
+        tlsExecutor = this;
+        tlsIndex = self;
+        std::uint64_t seed = 0x9E3779B97F4A7C15ull * (self + 1);
+        void *value;
+        while (!_stopping.load(std::memory_order_relaxed)) {
+            if (findWork(self, seed, value)) {
+                std::coroutine_handle<>::from_address(value).resume();
+                continue;
+            }
+            bool found = false;
+            for (int spin = 0; spin < 64 && !found; ++spin) { // 先自旋一会儿再睡
+                std::this_thread::yield();
+                found = findWork(self, seed, value);
+            }
+            if (found) {
+                std::coroutine_handle<>::from_address(value).resume();
+                continue;
+            }
+            _sleepers.fetch_add(1, std::memory_order_seq_cst);
+            auto epoch = _epoch.load(std::memory_order_acquire);
+            if (findWork(self, seed, value)) { // 登记睡眠后再看一眼, 防止丢失唤醒
+                _sleepers.fetch_sub(1, std::memory_order_relaxed);
+                std::coroutine_handle<>::from_address(value).resume();
+                continue;
+            }
+            if (!_stopping.load(std::memory_order_seq_cst)) {
+                _epoch.wait(epoch, std::memory_order_acquire);
+            }
+            _sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        tlsExecutor = nullptr;
+    }
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::mutex _injectMutex;
+    std::deque<void *> _inject; // 全局注入队列
+    std::atomic<std::size_t> _injectSize {0};
+    std::atomic<std::uint32_t> _epoch {0};  // 睡眠/唤醒用的版本号
+    std::atomic<std::uint32_t> _sleepers {0};
+    std::atomic<bool> _stopping {false};
+
+    static inline thread_local StealingExecutor *tlsExecutor = nullptr;
+    static inline thread_local std::size_t tlsIndex = 0;
+};
+
+} // namespace HX
+
+#endif // !_HX_STEALING_EXECUTOR_H_
@@ -20,12 +20,26 @@
 #ifndef _HX_TASK_H_
 #define _HX_TASK_H_
 
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <stop_token>
+
 #include "Uninitialized.hpp"
+#include "FrameAllocator.hpp"
 #include "RepeatAwaiter.hpp"
 #include "PreviousAwaiter.hpp"
 
 namespace HX {
 
+/**
+ * @brief Promise 是否带有取消令牌 `_stopToken`
+ */
+template <class P>
+concept HasStopToken = requires(P &promise) {
+    { promise._stopToken } -> std::convertible_to<std::stop_token const &>;
+};
+
 template <class T>
 struct Promise {
     auto initial_suspend() { 
@@ -49,7 +63,7 @@ struct Promise {
     }
 
     auto yield_value(T&& res) {
-        _res.putVal(res);
+        _res.putVal(std::move(res));
         return std::suspend_always(); // 挂起协程
     }
 
@@ -64,12 +78,23 @@ struct Promise {
         return std::coroutine_handle<Promise>::from_promise(*this);
     }
 
+#if !HX_NO_FRAME_POOL
+    static void *operator new(std::size_t size) { // 协程帧走线程局部的空闲链表
+        return HX::FrameAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+        HX::FrameAllocator::deallocate(ptr, size);
+    }
+#endif
+
     Promise &operator=(Promise &&) = delete;
 
     HX::Uninitialized<T> _res;
     
     std::coroutine_handle<> _previous {}; // 上一个协程句柄
     std::exception_ptr _exception {}; // 异常信息
+    std::stop_token _stopToken {}; // 取消令牌, co_await 时从等待者继承
 };
 
 template <>
@@ -99,10 +124,21 @@ struct Promise<void> {
         return std::coroutine_handle<Promise>::from_promise(*this);
     }
 
+#if !HX_NO_FRAME_POOL
+    static void *operator new(std::size_t size) { // 协程帧走线程局部的空闲链表
+        return HX::FrameAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+        HX::FrameAllocator::deallocate(ptr, size);
+    }
+#endif
+
     Promise &operator=(Promise &&) = delete;
     
     std::coroutine_handle<> _previous {}; // 上一个协程句柄
     std::exception_ptr _exception {}; // 异常信息
+    std::stop_token _stopToken {}; // 取消令牌, co_await 时从等待者继承
 };
 
 /**
@@ -125,6 +161,7 @@ struct [[nodiscard]] Task {
 
     Task &operator=(Task &&that) noexcept {
         std::swap(_coroutine, that._coroutine);
+        return *this;
     }
 
     ~Task() {
@@ -142,10 +179,17 @@ struct [[nodiscard]] Task {
          * @param coroutine 这个是`co_await`的协程句柄 (而不是 _coroutine)
          * @return std::coroutine_handle<promise_type> 
          */
+        template <class PP>
         std::coroutine_handle<promise_type> await_suspend(
-            std::coroutine_handle<> coroutine
+            std::coroutine_handle<PP> coroutine
         ) const noexcept {
             _coroutine.promise()._previous = coroutine; // 此处记录 co_await 之前的协程, 方便恢复
+            if constexpr (HasStopToken<PP> && HasStopToken<promise_type>) {
+                auto &token = _coroutine.promise()._stopToken;
+                if (!token.stop_possible()) { // 没有单独指定就继承等待者的
+                    token = coroutine.promise()._stopToken;
+                }
+            }
             return _coroutine;
         }
 
@@ -164,6 +208,21 @@ struct [[nodiscard]] Task {
         return _coroutine;
     }
 
+    /**
+     * @brief 单独指定取消令牌 (否则 co_await 时继承等待者的)
+     *
+     * 令牌只能在运行该任务的线程上触发 (request_stop): 挂起中的等待在触发时就地从本线程的循环上摘掉.
+     * 要从别的线程取消, 先把 request_stop 投递到那个线程 (EpollLoop::post).
+     */
+    Task &setStopToken(std::stop_token token) noexcept requires HasStopToken<promise_type> {
+        _coroutine.promise()._stopToken = std::move(token);
+        return *this;
+    }
+
+    bool hasStopToken() const noexcept requires HasStopToken<promise_type> {
+        return _coroutine.promise()._stopToken.stop_possible();
+    }
+
 private:
     std::coroutine_handle<promise_type> _coroutine; // 当前协程句柄
 };
@@ -176,6 +235,91 @@ T run_task(Loop &loop, Task<T, P> const &t) {
     return a.await_resume();
 };
 
+/**
+ * @brief `co_await current_stop_token()` 取得当前协程的取消令牌 (不挂起)
+ */
+struct StopTokenAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <class P>
+    bool await_suspend(std::coroutine_handle<P> coroutine) noexcept {
+        if constexpr (HasStopToken<P>) {
+            _token = coroutine.promise()._stopToken;
+        }
+        return false;
+    }
+
+    std::stop_token await_resume() noexcept {
+        return std::move(_token);
+    }
+
+    std::stop_token _token;
+};
+
+inline StopTokenAwaiter current_stop_token() noexcept {
+    return {};
+}
+
+/**
+ * @brief 把一个令牌的取消转发给 stop_source: `std::stop_callback<StopForwarder>(token, {&source})`
+ */
+struct StopForwarder {
+    void operator()() const noexcept {
+        _source->request_stop();
+    }
+
+    std::stop_source *_source;
+};
+
+/**
+ * @brief 分离的协程: 创建后挂起, 恢复后一直运行到结束, 结束时自行销毁协程帧
+ *
+ * 没有人等待它的结果, 其中未捕获的异常会直接 std::terminate (同 std::thread).
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept { // 结束即销毁
+            return {};
+        }
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+
+        void return_void() noexcept {
+        }
+
+#if !HX_NO_FRAME_POOL
+        static void *operator new(std::size_t size) {
+            return HX::FrameAllocator::allocate(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept {
+            HX::FrameAllocator::deallocate(ptr, size);
+        }
+#endif
+    };
+
+    std::coroutine_handle<promise_type> _coroutine; // 恢复一次即可, 不负责销毁
+};
+
+/**
+ * @brief 把 task 包成分离的协程, 返回待恢复的句柄 (可以交给任意线程的循环去恢复)
+ */
+inline DetachedTask detach(Task<void> task) {
+    co_await task;
+}
+
 } // namespace HX
 
 #endif // !_HX_TASK_H_
\ No newline at end of file
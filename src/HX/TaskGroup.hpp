@@ -0,0 +1,371 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-21 09:37:52
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_TASK_GROUP_H_
+#define _HX_TASK_GROUP_H_
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <stop_token>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Task.hpp"
+#include "FrameAllocator.hpp"
+
+namespace HX {
+
+class TaskGroupBase;
+
+/**
+ * @brief TaskGroup 的辅助协程: 等一个子任务, 结束时自行销毁;
+ *        是最后一个结束的则对称转移到等待 join 的协程
+ */
+struct TaskGroupHelperTask {
+    struct promise_type {
+        auto initial_suspend() noexcept {
+            return std::suspend_always();
+        }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> coroutine
+            ) const noexcept;
+
+            void await_resume() const noexcept {}
+        };
+
+        auto final_suspend() noexcept {
+            return FinalAwaiter();
+        }
+
+        void unhandled_exception() noexcept {
+            std::terminate(); // 辅助协程自己捕获子任务的异常, 不会走到这里
+        }
+
+        void return_void() noexcept {
+        }
+
+        TaskGroupHelperTask get_return_object() {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+#if !HX_NO_FRAME_POOL
+        static void *operator new(std::size_t size) {
+            return HX::FrameAllocator::allocate(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept {
+            HX::FrameAllocator::deallocate(ptr, size);
+        }
+#endif
+
+        TaskGroupBase *_group = nullptr;
+        std::stop_token _stopToken {}; // 组的取消令牌, 传给 co_await 的子任务
+    };
+
+    std::coroutine_handle<promise_type> _coroutine; // 启动前归组所有, 启动后自行销毁
+};
+
+/**
+ * @brief TaskGroup 与结果类型无关的部分: 并发计数、排队、取消、等待者
+ */
+class TaskGroupBase {
+public:
+    explicit TaskGroupBase(std::size_t maxConcurrency, std::stop_token parent) noexcept
+        : _maxConcurrency(maxConcurrency ? maxConcurrency : 1)
+        , _parentToken(std::move(parent))
+    {
+        if (_parentToken.stop_possible()) {
+            _parentLink.emplace(_parentToken, StopForwarder {&_stopSource});
+        }
+    }
+
+    TaskGroupBase &operator=(TaskGroupBase &&) = delete;
+
+    /**
+     * @brief 析构前须 co_await join(); 还在排队的子任务直接销毁
+     */
+    ~TaskGroupBase() {
+        dropPending();
+    }
+
+    /**
+     * @brief 取消全部子任务: 运行中的收到取消令牌, 排队中的不再启动
+     */
+    void cancel() noexcept {
+        _stopSource.request_stop();
+    }
+
+    std::stop_token stopToken() const noexcept {
+        return _stopSource.get_token();
+    }
+
+    /**
+     * @brief 正在运行的子任务数 (不超过 maxConcurrency)
+     */
+    std::size_t running() const noexcept {
+        return _running;
+    }
+
+    std::size_t pending() const noexcept {
+        return _pending.size();
+    }
+
+protected:
+    friend TaskGroupHelperTask::promise_type::FinalAwaiter;
+
+    /**
+     * @brief 排队, 名额未满则就地启动 (跑到第一次挂起为止)
+     */
+    void start(TaskGroupHelperTask helper) {
+        auto &promise = helper._coroutine.promise();
+        promise._group = this;
+        promise._stopToken = _stopSource.get_token();
+        _pending.push_back(helper._coroutine);
+        drive();
+    }
+
+    /**
+     * @brief 在名额内依次启动排队的子任务; 已在启动循环里 (子任务同步完成) 则什么也不做,
+     *        由外层的循环接着启动, 大量同步完成的子任务不会层层嵌套
+     */
+    void drive() {
+        if (_driving) {
+            return;
+        }
+        _driving = true;
+        while (_running < _maxConcurrency && !_pending.empty()
+               && !_stopSource.stop_requested()
+        ) {
+            auto next = _pending.front();
+            _pending.pop_front();
+            ++_running;
+            next.resume();
+        }
+        if (_stopSource.stop_requested()) {
+            dropPending();
+        }
+        _driving = false;
+    }
+
+    /**
+     * @brief 记下第一个异常并取消其余子任务
+     */
+    void fail(std::exception_ptr exception) noexcept {
+        if (!_exception) {
+            _exception = std::move(exception);
+            _stopSource.request_stop();
+        }
+    }
+
+    /**
+     * @brief 一个子任务结束: 名额让给排队的子任务; 全部结束则转回等待 join 的协程
+     * @return 接下来要对称转移过去的协程
+     */
+    std::coroutine_handle<> onChildDone() noexcept {
+        --_running;
+        if (_driving) { // 在 drive 的循环里同步完成, 回到循环
+            return std::noop_coroutine();
+        }
+        drive();
+        if (_running == 0 && _previous) {
+            return std::exchange(_previous, nullptr);
+        }
+        return std::noop_coroutine();
+    }
+
+    void dropPending() noexcept {
+        _skipped += _pending.size();
+        for (auto helper : _pending) {
+            helper.destroy(); // 还没启动, 连同其中的子任务一起销毁
+        }
+        _pending.clear();
+    }
+
+    struct JoinAwaiterBase {
+        bool await_ready() const noexcept {
+            return _group._running == 0;
+        }
+
+        /**
+         * @brief 等待者被取消时一并取消全部子任务
+         */
+        template <class P>
+        void await_suspend(std::coroutine_handle<P> coroutine) {
+            _group._previous = coroutine;
+            if constexpr (HasStopToken<P>) {
+                auto const &token = coroutine.promise()._stopToken;
+                if (token.stop_possible()) {
+                    _group._joinLink.emplace(token, StopForwarder {&_group._stopSource});
+                }
+            }
+        }
+
+        TaskGroupBase &_group;
+    };
+
+    /**
+     * @brief join 结束: 重新抛出第一个异常; 被取消而有子任务没运行则抛 operation_canceled.
+     *        之后组回到初始状态, 可以继续使用
+     */
+    void finishJoin() {
+        _joinLink.reset();
+        auto exception = std::exchange(_exception, nullptr);
+        bool skipped = std::exchange(_skipped, 0) != 0;
+        if (_stopSource.stop_requested()) {
+            _parentLink.reset();
+            _stopSource = std::stop_source();
+            if (_parentToken.stop_possible()) { // 父令牌转发到新的 source
+                _parentLink.emplace(_parentToken, StopForwarder {&_stopSource});
+            }
+        }
+        if (exception) [[unlikely]] {
+            std::rethrow_exception(exception);
+        }
+        if (skipped) [[unlikely]] {
+            throw std::system_error(std::make_error_code(std::errc::operation_canceled));
+        }
+    }
+
+    std::size_t _maxConcurrency;
+    std::size_t _running = 0;   // 正在运行的子任务
+    std::size_t _skipped = 0;   // 因取消没有运行的子任务
+    bool _driving = false;      // 是否在 drive 的循环里
+    std::deque<std::coroutine_handle<TaskGroupHelperTask::promise_type>> _pending; // 排队中的子任务
+    std::coroutine_handle<> _previous {}; // 等待 join 的协程
+    std::exception_ptr _exception {};     // 第一个异常
+    std::stop_source _stopSource;         // 子任务的取消令牌来源
+    std::stop_token _parentToken;         // 构造时给的父令牌
+    std::optional<std::stop_callback<StopForwarder>> _parentLink; // 父令牌触发时取消子任务
+    std::optional<std::stop_callback<StopForwarder>> _joinLink;   // join 的等待者的令牌
+};
+
+inline std::coroutine_handle<> TaskGroupHelperTask::promise_type::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> coroutine
+) const noexcept {
+    auto *group = coroutine.promise()._group;
+    coroutine.destroy();
+    return group->onChildDone();
+}
+
+/**
+ * @brief 结构化并发的任务组 (单线程): 在当前线程上运行子任务, 同时运行的不超过 maxConcurrency 个
+ *
+ * `group.spawn(task)` 名额未满时就地启动子任务, 否则排队, 有子任务结束时把名额交给队首;
+ * 每个子任务由一个辅助协程等待 (帧来自 FrameAllocator), 子任务结束时经 Promise 的
+ * `_previous` 对称转移回辅助协程, 最后一个结束的辅助协程再对称转移到 join 的等待者,
+ * 全程不经过任务队列, 也不轮询.
+ * 有子任务抛异常时记下第一个并取消其余子任务 (运行中的收到取消令牌, 排队中的直接销毁).
+ * `co_await group.join()` 等全部结束, 按 spawn 的顺序返回结果 (T 为 void 时不返回),
+ * 有异常则重新抛出第一个. 析构前必须 join.
+ * @tparam T 子任务的返回值类型
+ */
+template <class T = void>
+class TaskGroup : public TaskGroupBase {
+    static_assert(!std::is_reference_v<T>, "TaskGroup<T>: T 不能是引用");
+
+    using Slot = std::optional<typename NonVoidHelper<T>::Type>;
+
+public:
+    /**
+     * @param maxConcurrency 同时运行的子任务数上限 (0 视为 1)
+     * @param parent 父取消令牌, 触发时取消全部子任务; join 时等待者的令牌也会转发过来
+     */
+    explicit TaskGroup(
+        std::size_t maxConcurrency = std::numeric_limits<std::size_t>::max(),
+        std::stop_token parent = {}
+    ) noexcept
+        : TaskGroupBase(maxConcurrency, std::move(parent))
+    {}
+
+    /**
+     * @brief 加入一个子任务; 组已被取消则直接丢弃 (join 时抛 operation_canceled)
+     */
+    template <class P>
+    void spawn(Task<T, P> task) {
+        if (_stopSource.stop_requested()) {
+            ++_skipped;
+            return;
+        }
+        Slot *slot = nullptr;
+        if constexpr (!std::is_void_v<T>) {
+            slot = &_results.emplace_back();
+        }
+        start(helper(std::move(task), slot));
+    }
+
+    struct JoinAwaiter : JoinAwaiterBase {
+        /**
+         * @return 按 spawn 顺序的结果 (T 为 void 时为 void)
+         */
+        auto await_resume() {
+            auto &group = static_cast<TaskGroup &>(this->_group);
+            auto results = std::move(group._results);
+            group._results.clear();
+            group.finishJoin();
+            if constexpr (!std::is_void_v<T>) {
+                std::vector<T> res;
+                res.reserve(results.size());
+                for (auto &slot : results) {
+                    res.push_back(std::move(*slot));
+                }
+                return res;
+            }
+        }
+    };
+
+    /**
+     * @brief `co_await group.join()`: 等全部子任务结束 (不轮询, 最后一个结束的子任务直接转回来)
+     */
+    JoinAwaiter join() noexcept {
+        return {{*this}};
+    }
+
+private:
+    template <class P>
+    TaskGroupHelperTask helper(Task<T, P> task, Slot *slot) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+            } else {
+                auto res = co_await task; // 不直接写在 emplace 的实参里: GCC 12 对此生成错误代码
+                slot->emplace(std::move(res));
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    }
+
+    std::deque<Slot> _results; // 按 spawn 顺序, 地址稳定 (辅助协程持有指针)
+};
+
+} // namespace HX
+
+#endif // !_HX_TASK_GROUP_H_
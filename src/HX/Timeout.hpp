@@ -0,0 +1,107 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-18 10:26:41
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_TIMEOUT_H_
+#define _HX_TIMEOUT_H_
+
+#include <chrono>
+#include <optional>
+#include <stop_token>
+#include <system_error>
+
+#include "Task.hpp"
+#include "TimerLoop.hpp"
+#include "WhenAll.hpp"
+
+namespace HX {
+
+/**
+ * @brief 运行 task, 结束 (包括抛异常) 时触发 other
+ */
+template <class T, class P>
+Task<typename NonVoidHelper<T>::Type> runThenStop(Task<T, P> task, std::stop_source &other) {
+    struct StopGuard {
+        ~StopGuard() {
+            _source.request_stop();
+        }
+
+        std::stop_source &_source;
+    } guard {other};
+    co_return (co_await task, NonVoidHelper<>());
+}
+
+/**
+ * @brief 睡 timeout; 睡满 (没有被取消) 则记下超时并触发 other
+ */
+inline Task<void> sleepThenStop(
+    std::chrono::system_clock::duration timeout,
+    std::stop_source &other,
+    bool &timedOut
+) {
+    co_await TimerLoop::sleep_for(timeout);
+    auto token = co_await current_stop_token();
+    if (!token.stop_requested()) {
+        timedOut = true;
+        other.request_stop();
+    }
+}
+
+/**
+ * @brief `co_await with_timeout(task, 500ms)`: 超时则通过取消令牌取消 task
+ *
+ * task 与计时器并发运行, 谁先结束就取消另一个; 两者都结束后才返回,
+ * 所以超时返回时 task 已经观察到取消并退出 (挂起中的 epoll/io_uring 等待或计时器被摘掉),
+ * 不会留下引用当前帧的协程. task 原有的取消令牌被替换; 当前协程被取消时两者一并取消.
+ * 可取消的 I/O 原语被取消时抛 operation_canceled: 超时后 task 抛出的它就是超时, 返回 std::nullopt;
+ * 其余异常 (以及没有超时时的 operation_canceled) 原样重新抛出.
+ * @return 超时为 std::nullopt, 否则为 task 的结果 (void 为 NonVoidHelper<>)
+ */
+template <class T, class P>
+Task<std::optional<typename NonVoidHelper<T>::Type>> with_timeout(
+    Task<T, P> task,
+    std::chrono::system_clock::duration timeout
+) {
+    std::stop_source taskStop, timerStop;
+    std::optional<std::stop_callback<StopForwarder>> taskLink, timerLink;
+    if (auto parent = co_await current_stop_token(); parent.stop_possible()) {
+        taskLink.emplace(parent, StopForwarder {&taskStop});
+        timerLink.emplace(parent, StopForwarder {&timerStop});
+    }
+    task.setStopToken(taskStop.get_token());
+    bool timedOut = false;
+    auto timer = sleepThenStop(timeout, taskStop, timedOut);
+    timer.setStopToken(timerStop.get_token());
+    std::optional<typename NonVoidHelper<T>::Type> res;
+    try {
+        auto [value, _] = co_await when_all(
+            runThenStop(std::move(task), timerStop), std::move(timer));
+        if (!timedOut) {
+            res.emplace(std::move(value));
+        }
+    } catch (std::system_error const &e) {
+        if (!timedOut || e.code() != std::errc::operation_canceled) {
+            throw;
+        }
+    }
+    co_return res;
+}
+
+} // namespace HX
+
+#endif // !_HX_TIMEOUT_H_
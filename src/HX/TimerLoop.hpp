@@ -0,0 +1,379 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-15 22:14:37
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_TIMER_LOOP_H_
+#define _HX_TIMER_LOOP_H_
+
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <optional>
+#include <queue>
+#include <stop_token>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "Task.hpp"
+#include "CheckError.hpp"
+#include "TimingWheel.hpp"
+#include "../rbtree.hpp"
+
+/**
+ * @brief 定义 `HX_TIMER_WHEEL` 为 1 则计时器使用分层时间轮 (毫秒精度), 默认使用红黑树
+ */
+#ifndef HX_TIMER_WHEEL
+#define HX_TIMER_WHEEL 0
+#endif
+
+namespace HX {
+
+class TimerLoop {
+public:
+    struct TimerNode;
+
+    struct TimerNodeLess {
+        bool operator()(TimerNode const &lhs, TimerNode const &rhs) const noexcept;
+    };
+
+#if HX_TIMER_WHEEL
+    using TimerQueue = TimingWheel<TimerNode>;
+    using TimerHook = TimerQueue::WheelNode;
+#else
+    using TimerQueue = RbTree<TimerNode, TimerNodeLess>;
+    using TimerHook = TimerQueue::RbNode;
+#endif
+
+    /**
+     * @brief 计时器节点: 嵌在等待者 (协程帧) 里, 挂载不申请内存
+     */
+    struct TimerNode : TimerHook {
+        explicit TimerNode(std::chrono::system_clock::time_point expireTime) noexcept
+            : _expireTime(expireTime)
+        {}
+
+        std::chrono::system_clock::time_point _expireTime; // 过期时间
+        std::coroutine_handle<> _coroutine {};             // 到期后恢复的协程
+    };
+
+    void addTimer(TimerNode &node) noexcept {
+#if HX_TIMER_WHEEL
+        _timerQueue.insert(node, toTick(node._expireTime));
+#else
+        _timerQueue.insert(node);
+#endif
+    }
+
+    /**
+     * @brief 取消计时器; 已到期或未挂上的节点什么也不做
+     */
+    void cancelTimer(TimerNode &node) noexcept {
+        _timerQueue.erase(node);
+    }
+
+    void addTask(std::coroutine_handle<> coroutine) {
+        _taskQueue.emplace(coroutine);
+    }
+
+    /**
+     * @brief 执行任务队列中当前已有的任务 (执行中新加入的留到下一轮)
+     * @return 是否执行了任务
+     */
+    bool runTasks() {
+        std::size_t n = _taskQueue.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            auto task = std::move(_taskQueue.front());
+            _taskQueue.pop();
+            task.resume();
+        }
+        return n != 0;
+    }
+
+    bool hasTask() const noexcept {
+        return !_taskQueue.empty();
+    }
+
+    /**
+     * @brief 执行全部任务 (不含文件事件); 等待计时器时阻塞在 timerfd 上
+     */
+    void runAll() {
+        while (!_timerQueue.empty() || _taskQueue.size()) {
+            while (runTasks()) // 执行协程任务
+                ;
+
+            if (!_timerQueue.empty()) { // 执行计时器任务
+                if (auto timeout = run(); timeout && _taskQueue.empty()) {
+                    struct ::pollfd pfd {_timerFd, POLLIN, 0};
+                    ::poll(&pfd, 1, -1); // 全场睡大觉 [阻塞], 直到 timerfd 到期
+                    clearTimerFd();
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 执行全部已到期的计时器, 并把 timerfd 设置到下一个到期时间
+     * @return 距离下一个计时器到期的时长, 没有计时器则为 std::nullopt
+     */
+    std::optional<std::chrono::system_clock::duration> run() {
+        auto nowTime = std::chrono::system_clock::now();
+        auto nextTime = runExpired(nowTime);
+        armTimerFd(nextTime);
+        if (!nextTime) {
+            return std::nullopt;
+        }
+        if (*nextTime <= nowTime) {
+            return std::chrono::system_clock::duration::zero();
+        }
+        return *nextTime - nowTime;
+    }
+
+    /**
+     * @brief 计时器的 timerfd (CLOCK_REALTIME, 非阻塞), 由 EpollLoop 注册监听
+     */
+    int timerFd() const noexcept {
+        return _timerFd;
+    }
+
+    /**
+     * @brief 读走 timerfd 的到期计数, 使其不再可读;
+     *        同时忘掉已设置的到期时间, 之后即使设置同一个时间也会重新进内核
+     *        (时间轮的 nextTick 可能就是这个已消耗的时间)
+     */
+    void clearTimerFd() noexcept {
+        std::uint64_t expirations;
+        [[maybe_unused]] auto _ = ::read(_timerFd, &expirations, sizeof(expirations));
+        _armedTime.reset();
+    }
+
+    bool hasTimer() const noexcept {
+        return !_timerQueue.empty();
+    }
+
+    /**
+     * @brief 是否用 timerfd 唤醒; 等待点自带超时 (如 io_uring_enter) 时可以关掉
+     */
+    void useTimerFd(bool enable) noexcept {
+        _useTimerFd = enable;
+    }
+
+    static TimerLoop& getLoop() {
+        static thread_local TimerLoop loop; // 每个线程一个循环
+        return loop;
+    }
+
+    /**
+     * @brief 是否是当前线程的循环 (不会为没有循环的线程创建循环)
+     */
+    bool isCurrent() const noexcept {
+        return tlsCurrent == this;
+    }
+
+private:
+    /**
+     * @brief 执行在 nowTime 之前到期的计时器
+     * @return 下一个计时器的到期时间
+     */
+    std::optional<std::chrono::system_clock::time_point> runExpired(
+        std::chrono::system_clock::time_point nowTime
+    ) {
+#if HX_TIMER_WHEEL
+        // 时间轮批量摘下到期的槽, 逐个恢复
+        _timerQueue.advance(
+            std::chrono::floor<std::chrono::milliseconds>(
+                nowTime.time_since_epoch()).count(),
+            [](TimerNode &node) {
+                node._coroutine.resume();
+            });
+        auto tick = _timerQueue.nextTick();
+        if (!tick) {
+            return std::nullopt;
+        }
+        return std::chrono::system_clock::time_point {std::chrono::milliseconds(*tick)};
+#else
+        while (!_timerQueue.empty()) {
+            auto &node = _timerQueue.front();
+            if (node._expireTime > nowTime) {
+                return node._expireTime;
+            }
+            _timerQueue.erase(node); // 先摘除再恢复, 恢复后节点所在的帧可能已被销毁
+            node._coroutine.resume();
+        }
+        return std::nullopt;
+#endif
+    }
+
+    /**
+     * @brief 把 timerfd 设置为在 expireTime 到期 (绝对时间, 纳秒精度); nullopt 则停止
+     */
+    void armTimerFd(std::optional<std::chrono::system_clock::time_point> expireTime) noexcept {
+        if (!_useTimerFd) {
+            expireTime.reset();
+        }
+        if (expireTime == _armedTime) { // 没变就不必再进内核
+            return;
+        }
+        _armedTime = expireTime;
+        struct ::itimerspec spec {};
+        if (expireTime) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                expireTime->time_since_epoch()).count();
+            if (ns <= 0) { // it_value 全 0 表示停止, 已过期的时间至少给 1ns
+                ns = 1;
+            }
+            spec.it_value.tv_sec = ns / 1'000'000'000;
+            spec.it_value.tv_nsec = ns % 1'000'000'000;
+        }
+        ::timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    /**
+     * @brief 暂停者
+     */
+    struct SleepAwaiter : TimerNode { // 使用 co_await 则需要定义这 3 个固定函数
+        using TimerNode::TimerNode;
+
+        /**
+         * @brief 取消: 摘掉计时器, 协程放回任务队列, 由循环恢复 (不在 request_stop 里直接恢复);
+         *        只能在挂上计时器的线程上触发
+         */
+        struct Canceller {
+            void operator()() const noexcept {
+                auto &loop = *_self->_loop;
+                assert(loop.isCurrent() && "取消令牌须在等待者所在的线程上触发");
+                loop.cancelTimer(*_self);
+                _self->_cancelled = true;
+                loop.addTask(_self->_coroutine);
+            }
+
+            SleepAwaiter *_self;
+        };
+
+        bool await_ready() const noexcept { // 暂停
+            return false;
+        }
+
+        template <class P>
+        bool await_suspend(std::coroutine_handle<P> coroutine) { // `await_ready`后执行: 添加计时器
+            _coroutine = coroutine;
+            _loop = &TimerLoop::getLoop();
+            if constexpr (HasStopToken<P>) {
+                auto const &token = coroutine.promise()._stopToken;
+                if (token.stop_requested()) {
+                    _cancelled = true;
+                    return false;
+                }
+                if (token.stop_possible()) {
+                    _stopCallback.emplace(token, Canceller {this});
+                }
+            }
+            _loop->addTimer(*this);
+            return true;
+        }
+
+        /**
+         * @return 是否睡满 (被取消则为 false)
+         */
+        bool await_resume() const noexcept { // 计时结束
+            return !_cancelled;
+        }
+
+        TimerLoop *_loop = nullptr; // 挂上计时器的循环
+        bool _cancelled = false;
+        std::optional<std::stop_callback<Canceller>> _stopCallback;
+    };
+
+public:
+    /**
+     * @brief 暂停指定时间点; 取消令牌被触发时提前返回
+     * @param expireTime 时间点, 如 2024-8-4 22:12:23
+     */
+    HX::Task<void> static sleep_until(std::chrono::system_clock::time_point expireTime) {
+        co_await SleepAwaiter(expireTime);
+    }
+
+    /**
+     * @brief 暂停一段时间; 取消令牌被触发时提前返回
+     * @param duration 比如 3s
+     */
+    HX::Task<void> static sleep_for(std::chrono::system_clock::duration duration) {
+        co_await SleepAwaiter(std::chrono::system_clock::now() + duration);
+    }
+
+private:
+#if HX_TIMER_WHEEL
+    explicit TimerLoop() : _timerQueue(std::chrono::floor<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch()).count())
+                         , _taskQueue()
+                         , _timerFd(HX::checkError(::timerfd_create(
+                               CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC)))
+    {
+        tlsCurrent = this;
+    }
+
+    /**
+     * @brief 时间点转换为时间轮的 tick (毫秒, 向上取整, 保证不会提前触发)
+     */
+    static std::uint64_t toTick(std::chrono::system_clock::time_point time) noexcept {
+        return std::chrono::ceil<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    }
+#else
+    explicit TimerLoop() : _timerQueue()
+                         , _taskQueue()
+                         , _timerFd(HX::checkError(::timerfd_create(
+                               CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC)))
+    {
+        tlsCurrent = this;
+    }
+#endif
+
+    ~TimerLoop() {
+        tlsCurrent = nullptr;
+        ::close(_timerFd);
+    }
+
+    TimerLoop& operator=(TimerLoop&&) = delete;
+
+    /// @brief 计时器队列 (侵入式, 节点在 SleepAwaiter 中): 红黑树或时间轮
+    TimerQueue _timerQueue;
+
+    /// @brief 任务队列
+    std::queue<std::coroutine_handle<>> _taskQueue;
+
+    /// @brief 下一个计时器的 timerfd, 与 system_clock 同为 CLOCK_REALTIME
+    int _timerFd = -1;
+
+    /// @brief timerfd 当前设置的到期时间
+    std::optional<std::chrono::system_clock::time_point> _armedTime;
+
+    bool _useTimerFd = true;
+
+    static inline thread_local TimerLoop *tlsCurrent = nullptr;
+};
+
+inline bool TimerLoop::TimerNodeLess::operator()(
+    TimerNode const &lhs,
+    TimerNode const &rhs
+) const noexcept {
+    return lhs._expireTime < rhs._expireTime;
+}
+
+} // namespace HX
+
+#endif // !_HX_TIMER_LOOP_H_
@@ -0,0 +1,345 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-15 23:02:41
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_TIMING_WHEEL_H_
+#define _HX_TIMING_WHEEL_H_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace HX {
+
+/**
+ * @brief 分层哈希时间轮 (侵入式): 挂载/取消 O(1), 到期按槽批量触发
+ *
+ * 共 4 层, 每层 64 个槽, 第 l 层一个槽跨 64^l 个 tick;
+ * 超出 64^4 个 tick 的放进溢出链表, 等最高层转完一圈再重新挂载.
+ * 低层转完一圈时把上一层对应槽里的节点重新分配到低层 (cascade).
+ *
+ * 每层用一个 64 位位图记录非空槽, 推进时间时直接跳到下一个有事可做的 tick,
+ * 长时间空闲后推进的代价与经过的 tick 数无关.
+ *
+ * Value 需要继承 WheelNode; 节点析构时若仍挂在时间轮上会自动摘除.
+ * @tparam Value 节点类型
+ */
+template <class Value>
+struct TimingWheel {
+    static constexpr unsigned kLevelBits = 6;
+    static constexpr unsigned kSlotCount = 1u << kLevelBits;
+    static constexpr unsigned kLevelCount = 4;
+    static constexpr std::uint64_t kSlotMask = kSlotCount - 1;
+
+    struct WheelNode {
+        WheelNode() noexcept = default;
+
+        WheelNode(WheelNode &&) = delete;
+
+        ~WheelNode() noexcept {
+            if (wheel) {
+                wheel->doErase(this);
+            }
+        }
+
+        bool isLinked() const noexcept {
+            return wheel != nullptr;
+        }
+
+        /**
+         * @brief 挂载时的到期 tick
+         */
+        std::uint64_t expireTick() const noexcept {
+            return tick;
+        }
+
+        friend struct TimingWheel;
+
+    private:
+        WheelNode *next = nullptr;
+        WheelNode **pprev = nullptr; // 指向前一个节点的 next (或链表头)
+        TimingWheel *wheel = nullptr;
+        std::uint64_t tick = 0;
+        unsigned slot = 0; // level * kSlotCount + index; 见 kReadySlot 等
+    };
+
+private:
+    static constexpr unsigned kReadySlot = kLevelCount * kSlotCount; // 挂载时已到期
+    static constexpr unsigned kOverflowSlot = kReadySlot + 1;        // 超出最高层
+    static constexpr unsigned kBatchSlot = kReadySlot + 2;           // 正在触发的批次
+
+    WheelNode *slots[kLevelCount][kSlotCount] {};
+    std::uint64_t bitmaps[kLevelCount] {};
+    WheelNode *ready = nullptr;
+    WheelNode *overflow = nullptr;
+    std::uint64_t current; // 最后一个已处理的 tick
+    std::size_t count = 0;
+
+    static void linkTo(WheelNode *&head, WheelNode *node) noexcept {
+        node->next = head;
+        if (head) {
+            head->pprev = &node->next;
+        }
+        head = node;
+        node->pprev = &head;
+    }
+
+    static void unlink(WheelNode *node) noexcept {
+        *node->pprev = node->next;
+        if (node->next) {
+            node->next->pprev = node->pprev;
+        }
+        node->next = nullptr;
+        node->pprev = nullptr;
+    }
+
+    void place(WheelNode *node) noexcept {
+        std::uint64_t tick = node->tick;
+        if (tick <= current) {
+            node->slot = kReadySlot;
+            linkTo(ready, node);
+            return;
+        }
+        std::uint64_t delta = tick - current;
+        for (unsigned level = 0; level < kLevelCount; ++level) {
+            if (delta < (std::uint64_t(1) << (kLevelBits * (level + 1)))) {
+                unsigned idx = (tick >> (kLevelBits * level)) & kSlotMask;
+                node->slot = level * kSlotCount + idx;
+                linkTo(slots[level][idx], node);
+                bitmaps[level] |= std::uint64_t(1) << idx;
+                return;
+            }
+        }
+        node->slot = kOverflowSlot;
+        linkTo(overflow, node);
+    }
+
+    void doErase(WheelNode *node) noexcept {
+        if (node->wheel != this) { // 不在本时间轮上
+            return;
+        }
+        unlink(node);
+        if (node->slot < kReadySlot) {
+            unsigned level = node->slot / kSlotCount;
+            unsigned idx = node->slot % kSlotCount;
+            if (!slots[level][idx]) {
+                bitmaps[level] &= ~(std::uint64_t(1) << idx);
+            }
+        }
+        node->wheel = nullptr;
+        --count;
+    }
+
+    void cascade(unsigned level, unsigned idx) noexcept {
+        WheelNode *batch = slots[level][idx];
+        slots[level][idx] = nullptr;
+        bitmaps[level] &= ~(std::uint64_t(1) << idx);
+        while (batch) {
+            WheelNode *node = batch;
+            batch = node->next;
+            place(node);
+        }
+    }
+
+    void reinsertOverflow() noexcept {
+        WheelNode *batch = overflow;
+        overflow = nullptr;
+        while (batch) {
+            WheelNode *node = batch;
+            batch = node->next;
+            place(node);
+        }
+    }
+
+    /**
+     * @brief 逐个触发一个批次; 回调里取消同批次的其他节点也是安全的
+     */
+    template <class Callback>
+    void fire(WheelNode *&head, Callback &callback) {
+        WheelNode *batch = head;
+        head = nullptr;
+        if (!batch) {
+            return;
+        }
+        batch->pprev = &batch;
+        for (WheelNode *node = batch; node; node = node->next) {
+            node->slot = kBatchSlot;
+        }
+        while (batch) {
+            WheelNode *node = batch;
+            unlink(node);
+            node->wheel = nullptr;
+            --count;
+            callback(static_cast<Value &>(*node));
+        }
+    }
+
+    /**
+     * @brief 处理第 tick 个刻度: 先 cascade 高层, 再触发第 0 层的槽
+     */
+    template <class Callback>
+    void processTick(std::uint64_t tick, Callback &callback) {
+        current = tick;
+        for (unsigned level = 1; level < kLevelCount; ++level) {
+            if (tick & ((std::uint64_t(1) << (kLevelBits * level)) - 1)) {
+                break;
+            }
+            cascade(level, (tick >> (kLevelBits * level)) & kSlotMask);
+            if (level == kLevelCount - 1
+                && !(tick & ((std::uint64_t(1) << (kLevelBits * kLevelCount)) - 1))
+            ) {
+                reinsertOverflow();
+            }
+        }
+        unsigned idx = tick & kSlotMask;
+        if (bitmaps[0] & (std::uint64_t(1) << idx)) {
+            bitmaps[0] &= ~(std::uint64_t(1) << idx);
+            fire(slots[0][idx], callback);
+        }
+        fire(ready, callback); // cascade 下来恰好在本 tick 到期的
+    }
+
+    /**
+     * @brief 下一个需要处理的 tick (有槽到期或需要 cascade), 没有则返回 nullopt
+     */
+    std::optional<std::uint64_t> nextEventTick() const noexcept {
+        std::optional<std::uint64_t> res;
+        for (unsigned level = 0; level < kLevelCount; ++level) {
+            if (!bitmaps[level]) {
+                continue;
+            }
+            unsigned shift = kLevelBits * level;
+            std::uint64_t base = current >> shift;
+            unsigned from = (base + 1) & kSlotMask;
+            // 把位图旋转到以 from 为第 0 位, 第一个置位即最近的非空槽
+            std::uint64_t rotated = std::rotr(bitmaps[level], (int)from);
+            std::uint64_t dist = (std::uint64_t)std::countr_zero(rotated) + 1;
+            std::uint64_t tick = (base + dist) << shift;
+            if (!res || tick < *res) {
+                res = tick;
+            }
+        }
+        if (overflow) {
+            unsigned shift = kLevelBits * kLevelCount;
+            std::uint64_t tick = ((current >> shift) + 1) << shift;
+            if (!res || tick < *res) {
+                res = tick;
+            }
+        }
+        return res;
+    }
+
+public:
+    explicit TimingWheel(std::uint64_t nowTick = 0) noexcept : current(nowTick) {}
+
+    TimingWheel(TimingWheel &&) = delete;
+
+    ~TimingWheel() noexcept {
+        clear();
+    }
+
+    /**
+     * @brief 挂载节点, O(1)
+     * @param tick 到期的 tick; 不大于当前 tick 的节点进入已到期链表, 由 advance 触发
+     *        (在 advance 的回调里挂载的, 见 advance)
+     */
+    void insert(Value &value, std::uint64_t tick) noexcept {
+        WheelNode *node = &static_cast<WheelNode &>(value);
+        doErase(node);
+        node->tick = tick;
+        node->wheel = this;
+        ++count;
+        place(node);
+    }
+
+    /**
+     * @brief 摘除节点, O(1); 节点不在本时间轮上时什么也不做
+     */
+    void erase(Value &value) noexcept {
+        doErase(&static_cast<WheelNode &>(value));
+    }
+
+    /**
+     * @brief 摘除全部节点 (不会析构它们)
+     */
+    void clear() noexcept {
+        auto drop = [this](WheelNode *&head) {
+            while (head) {
+                doErase(head);
+            }
+        };
+        for (auto &level : slots) {
+            for (auto &head : level) {
+                drop(head);
+            }
+        }
+        drop(ready);
+        drop(overflow);
+        for (auto &bitmap : bitmaps) {
+            bitmap = 0;
+        }
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    std::uint64_t currentTick() const noexcept {
+        return current;
+    }
+
+    /**
+     * @brief 把时间推进到 nowTick, 对每个到期节点调用 callback(Value &)
+     *
+     * 挂载时就已到期的节点先触发. 回调中新挂载的已到期节点: 若本次还要处理后面的 tick,
+     * 在处理那个 tick 时一并触发 (每个 tick 末尾都会触发已到期链表); 否则留到下一次 advance.
+     * 每批都是先摘下整条链表再触发, 所以回调反复挂载已到期节点也不会在同一批里死循环.
+     */
+    template <class Callback>
+    void advance(std::uint64_t nowTick, Callback &&callback) {
+        fire(ready, callback);
+        while (current < nowTick) {
+            auto tick = nextEventTick();
+            if (!tick || *tick > nowTick) {
+                current = nowTick;
+                break;
+            }
+            processTick(*tick, callback);
+        }
+    }
+
+    /**
+     * @brief 下一次需要调用 advance 的 tick (可能早于实际到期, 用于 cascade)
+     * @return 时间轮为空则返回 nullopt; 有已到期节点则返回当前 tick
+     */
+    std::optional<std::uint64_t> nextTick() const noexcept {
+        if (ready) {
+            return current;
+        }
+        return nextEventTick();
+    }
+};
+
+} // namespace HX
+
+#endif // !_HX_TIMING_WHEEL_H_
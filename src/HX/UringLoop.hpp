@@ -0,0 +1,941 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 14:02:26
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_URING_LOOP_H_
+#define _HX_URING_LOOP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <vector>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "EpollLoop.hpp"
+
+/**
+ * @brief 定义 `HX_USE_IO_URING` 为 1 则 AsyncFile 的读写/连接走 io_uring;
+ *        内核不支持 (io_uring_setup 失败) 时运行期自动退回 EpollLoop
+ */
+#ifndef HX_USE_IO_URING
+#define HX_USE_IO_URING 0
+#endif
+
+namespace HX {
+
+/**
+ * @brief 一个进行中的 io_uring 请求; sqe 的 user_data 指向它
+ *
+ * 完成时调用 `_complete(this, cqe->res, cqe->flags)`.
+ * 多次完成 (multishot) 的请求会带着 IORING_CQE_F_MORE 被多次调用.
+ */
+struct UringRequest {
+    void (*_complete)(UringRequest *self, int res, std::uint32_t flags) = nullptr;
+};
+
+class UringLoop {
+public:
+    static constexpr unsigned kEntries = 256;          // SQ 深度
+    static constexpr unsigned kMaxFixedFiles = 1024;   // 注册文件表大小
+    static constexpr unsigned kRecvBufCount = 256;     // multishot recv 的缓冲个数 (2 的幂)
+    static constexpr unsigned kRecvBufSize = 16 * 1024;
+    static constexpr std::uint16_t kRecvBufGroup = 0;
+
+private:
+    UringLoop& operator=(UringLoop&&) = delete;
+
+    explicit UringLoop() {
+        tlsCurrent = this;
+        struct ::io_uring_params params {};
+        params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+        _ringFd = (int)::syscall(__NR_io_uring_setup, kEntries, &params);
+        if (_ringFd < 0) { // 老内核不认识这些 flags, 退一步再试
+            params = {};
+            _ringFd = (int)::syscall(__NR_io_uring_setup, kEntries, &params);
+        }
+        if (_ringFd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP)
+            || !(params.features & IORING_FEAT_NODROP)
+        ) {
+            closeRing();
+            return;
+        }
+        _extArg = params.features & IORING_FEAT_EXT_ARG;
+
+        _ringSize = std::max(
+            params.sq_off.array + params.sq_entries * sizeof(std::uint32_t),
+            params.cq_off.cqes + params.cq_entries * sizeof(struct ::io_uring_cqe));
+        _ring = ::mmap(nullptr, _ringSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+        _sqesSize = params.sq_entries * sizeof(struct ::io_uring_sqe);
+        _sqes = (struct ::io_uring_sqe *)::mmap(
+            nullptr, _sqesSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+        if (_ring == MAP_FAILED || _sqes == MAP_FAILED) {
+            closeRing();
+            return;
+        }
+
+        auto *base = (char *)_ring;
+        _sqHead = (unsigned *)(base + params.sq_off.head);
+        _sqTail = (unsigned *)(base + params.sq_off.tail);
+        _sqMask = *(unsigned *)(base + params.sq_off.ring_mask);
+        _sqEntries = params.sq_entries;
+        auto *sqArray = (unsigned *)(base + params.sq_off.array);
+        for (unsigned i = 0; i < _sqEntries; ++i) {
+            sqArray[i] = i; // sqe 下标与 SQ 槽一一对应
+        }
+        _cqHead = (unsigned *)(base + params.cq_off.head);
+        _cqTail = (unsigned *)(base + params.cq_off.tail);
+        _cqMask = *(unsigned *)(base + params.cq_off.ring_mask);
+        _cqes = (struct ::io_uring_cqe *)(base + params.cq_off.cqes);
+        _localTail = *_sqTail;
+
+        registerSparseFiles();
+        watchEpoll();
+    }
+
+    ~UringLoop() {
+        tlsCurrent = nullptr;
+        _recvBufs.reset();
+        closeRing();
+    }
+
+    void closeRing() noexcept {
+        if (_sqes && _sqes != MAP_FAILED) {
+            ::munmap(_sqes, _sqesSize);
+        }
+        if (_ring && _ring != MAP_FAILED) {
+            ::munmap(_ring, _ringSize);
+        }
+        _sqes = nullptr;
+        _ring = nullptr;
+        if (_ringFd >= 0) {
+            ::close(_ringFd);
+        }
+        _ringFd = -1;
+    }
+
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags,
+              void *arg = nullptr, std::size_t argSize = 0) noexcept {
+        return (int)::syscall(__NR_io_uring_enter, _ringFd, toSubmit,
+                              minComplete, flags, arg, argSize);
+    }
+
+    int registerOp(unsigned opcode, void const *arg, unsigned nrArgs) noexcept {
+        return (int)::syscall(__NR_io_uring_register, _ringFd, opcode, arg, nrArgs);
+    }
+
+    /**
+     * @brief 注册一张空的文件表, 之后按需用 FILES_UPDATE 填槽
+     */
+    void registerSparseFiles() {
+        struct ::io_uring_rsrc_register reg {};
+        reg.nr = kMaxFixedFiles;
+        reg.flags = IORING_RSRC_REGISTER_SPARSE;
+        if (registerOp(IORING_REGISTER_FILES2, &reg, sizeof(reg)) < 0) {
+            return; // 不支持就不用注册文件
+        }
+        _freeFixedFiles.reserve(kMaxFixedFiles);
+        for (int i = kMaxFixedFiles - 1; i >= 0; --i) {
+            _freeFixedFiles.push_back(i);
+        }
+    }
+
+    /**
+     * @brief 在环上挂一个 multishot poll 监听 epoll fd,
+     *        这样 EpollLoop 上的文件与 timerfd 也汇入同一个等待点 (io_uring_enter)
+     */
+    void watchEpoll() {
+        _epollWatch._complete = [](UringRequest *, int res, std::uint32_t flags) {
+            auto &loop = UringLoop::get();
+            if (res >= 0) {
+                EpollLoop::get().run(std::chrono::system_clock::duration::zero());
+            }
+            if (!(flags & IORING_CQE_F_MORE)) {
+                loop._epollWatched = false; // 被内核终止了, 下一轮重新挂
+            }
+        };
+        auto *sqe = getSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = EpollLoop::get()._epfd;
+        sqe->len = IORING_POLL_ADD_MULTI;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = (std::uint64_t)&_epollWatch;
+        _epollWatched = true;
+    }
+
+    /**
+     * @brief 把本地累积的 sqe 发布给内核 (更新 SQ tail)
+     */
+    unsigned flushSqes() noexcept {
+        unsigned toSubmit = _localTail - *_sqTail;
+        std::atomic_ref<unsigned>(*_sqTail).store(_localTail, std::memory_order_release);
+        return toSubmit;
+    }
+
+    /**
+     * @brief 处理 CQ 上全部已完成的请求
+     */
+    std::size_t reap() {
+        std::size_t n = 0;
+        unsigned head = *_cqHead;
+        while (true) {
+            unsigned tail = std::atomic_ref<unsigned>(*_cqTail).load(std::memory_order_acquire);
+            if (head == tail) {
+                break;
+            }
+            // 先拷出 cqe 再推进 head, 把槽尽快还给内核
+            auto &cqe = _cqes[head & _cqMask];
+            std::uint64_t userData = cqe.user_data;
+            int res = cqe.res;
+            std::uint32_t flags = cqe.flags;
+            ++head;
+            std::atomic_ref<unsigned>(*_cqHead).store(head, std::memory_order_release);
+            if (!userData) {
+                continue;
+            }
+            auto *req = (UringRequest *)userData;
+            if (!(flags & IORING_CQE_F_MORE) && req != &_epollWatch) {
+                --_inflight;
+            }
+            req->_complete(req, res, flags);
+            head = *_cqHead;
+            ++n;
+        }
+        return n;
+    }
+
+public:
+    static UringLoop& get() {
+        static thread_local UringLoop loop; // 每个线程一个循环
+        return loop;
+    }
+
+    /**
+     * @brief 是否是当前线程的循环 (不会为没有循环的线程创建循环)
+     */
+    bool isCurrent() const noexcept {
+        return tlsCurrent == this;
+    }
+
+    /**
+     * @brief io_uring 是否可用 (编译期开启且内核支持)
+     */
+    static bool isEnabled() noexcept {
+#if HX_USE_IO_URING
+        return get()._ringFd >= 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief 取一个空闲的 sqe (已清零); SQ 满了会先把已有的提交掉
+     */
+    struct ::io_uring_sqe *getSqe() {
+        if (_localTail - std::atomic_ref<unsigned>(*_sqHead).load(std::memory_order_acquire)
+            >= _sqEntries
+        ) [[unlikely]] {
+            enter(flushSqes(), 0, 0);
+        }
+        auto *sqe = &_sqes[_localTail & _sqMask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++_localTail;
+        return sqe;
+    }
+
+    /**
+     * @brief 提交一个请求 (延迟到本轮循环结束时批量提交)
+     */
+    void submit(struct ::io_uring_sqe const &prepared, UringRequest *req) {
+        auto *sqe = getSqe();
+        *sqe = prepared;
+        sqe->user_data = (std::uint64_t)req;
+        ++_inflight;
+    }
+
+    /**
+     * @brief 提交 IORING_OP_ASYNC_CANCEL 取消 req: req 之后以 -ECANCELED (或赶在取消前的结果) 完成;
+     *        取消请求本身的完成事件不关心 (user_data 为 0)
+     */
+    void cancel(UringRequest *req) {
+        auto *sqe = getSqe();
+        *sqe = prepare(IORING_OP_ASYNC_CANCEL, -1, -1, req, 0, 0);
+        sqe->user_data = 0;
+    }
+
+    bool hasEvent() const noexcept {
+        return _inflight != 0;
+    }
+
+    /**
+     * @brief io_uring_enter 能否直接带超时等待 (IORING_FEAT_EXT_ARG)
+     */
+    bool canWaitTimeout() const noexcept {
+        return _extArg;
+    }
+
+    /**
+     * @brief 一次 io_uring_enter: 提交本轮全部 sqe, 等待并处理完成事件
+     * @param timeout 距离下一个计时器的时长; 为 0 时不等待
+     * @return 无事可等时返回 false
+     */
+    bool run(std::optional<std::chrono::system_clock::duration> timeout) {
+        if (!_inflight && !timeout && !EpollLoop::get().hasEvent()) {
+            return false;
+        }
+        if (!_epollWatched) {
+            watchEpoll();
+        }
+        unsigned toSubmit = flushSqes();
+        unsigned flags = IORING_ENTER_GETEVENTS;
+        unsigned minComplete = 1;
+        struct ::io_uring_getevents_arg arg {};
+        struct ::__kernel_timespec ts {};
+        if (timeout) {
+            if (*timeout <= std::chrono::system_clock::duration::zero()) {
+                minComplete = 0;
+            } else if (_extArg) { // 计时器的等待直接交给 io_uring_enter, 纳秒精度
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(*timeout).count();
+                ts.tv_sec = ns / 1'000'000'000;
+                ts.tv_nsec = ns % 1'000'000'000;
+                arg.ts = (std::uint64_t)&ts;
+                flags |= IORING_ENTER_EXT_ARG;
+            } // 否则由挂在 epoll 上的 timerfd 唤醒
+        }
+        if (flags & IORING_ENTER_EXT_ARG) {
+            enter(toSubmit, minComplete, flags, &arg, sizeof(arg));
+        } else {
+            enter(toSubmit, minComplete, flags);
+        }
+        reap();
+        return true;
+    }
+
+    /**
+     * @brief 把 fd 放进注册文件表, 之后的请求免去每次的 fget/fput
+     * @return 表中下标; 不支持或表满返回 -1
+     */
+    int registerFile(int fd) {
+        if (_freeFixedFiles.empty()) {
+            return -1;
+        }
+        int idx = _freeFixedFiles.back();
+        struct ::io_uring_rsrc_update2 up {};
+        up.offset = (unsigned)idx;
+        up.data = (std::uint64_t)&fd;
+        up.nr = 1;
+        if (registerOp(IORING_REGISTER_FILES_UPDATE2, &up, sizeof(up)) < 0) {
+            return -1;
+        }
+        _freeFixedFiles.pop_back();
+        return idx;
+    }
+
+    void unregisterFile(int idx) {
+        if (idx < 0) {
+            return;
+        }
+        int fd = -1;
+        struct ::io_uring_rsrc_update2 up {};
+        up.offset = (unsigned)idx;
+        up.data = (std::uint64_t)&fd;
+        up.nr = 1;
+        registerOp(IORING_REGISTER_FILES_UPDATE2, &up, sizeof(up));
+        _freeFixedFiles.push_back(idx);
+    }
+
+    /**
+     * @brief 注册固定缓冲区 (同一时间只能有一组, 换之前先 unregisterBuffers):
+     *        内核预先锁定并映射这些页面, 之后落在其中的读写 (AsyncFile 自动识别,
+     *        或直接用 readFixed/writeFixed) 免去每次的页表遍历与引用计数
+     */
+    bool registerBuffers(std::span<struct ::iovec const> bufs) {
+        if (!_fixedBuffers.empty()
+            || registerOp(IORING_REGISTER_BUFFERS, bufs.data(), (unsigned)bufs.size()) != 0
+        ) {
+            return false;
+        }
+        _fixedBuffers.assign(bufs.begin(), bufs.end());
+        return true;
+    }
+
+    void unregisterBuffers() {
+        if (_fixedBuffers.empty()) {
+            return;
+        }
+        registerOp(IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        _fixedBuffers.clear();
+    }
+
+    /**
+     * @brief [data, data + len) 完整地落在哪一块已注册的缓冲区里
+     * @return 缓冲区下标, 不在任何一块里返回 -1
+     */
+    int findFixedBuffer(void const *data, std::size_t len) const noexcept {
+        auto addr = (std::uintptr_t)data;
+        for (std::size_t i = 0; i < _fixedBuffers.size(); ++i) {
+            auto base = (std::uintptr_t)_fixedBuffers[i].iov_base;
+            if (addr >= base && addr + len <= base + _fixedBuffers[i].iov_len) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief 提供给 multishot recv 的缓冲环 (IORING_REGISTER_PBUF_RING)
+     *
+     * 内核每收到一段数据就从环上取一块缓冲, 用户用完后原样放回, 全程无系统调用.
+     */
+    class RecvBufferRing {
+    public:
+        /**
+         * @brief 等缓冲的请求: 缓冲用完 (-ENOBUFS) 而停下的 multishot recv, 有缓冲归还时由 _wake 重新挂上
+         */
+        struct BufferWaiter {
+            void (*_wake)(BufferWaiter *self) = nullptr;
+        };
+
+        explicit RecvBufferRing(UringLoop &loop) : _loop(loop) {
+            std::size_t ringBytes = kRecvBufCount * sizeof(struct ::io_uring_buf);
+            _ring = (struct ::io_uring_buf_ring *)::mmap(
+                nullptr, ringBytes, PROT_READ | PROT_WRITE,
+                MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+            if (_ring == MAP_FAILED) {
+                _ring = nullptr;
+                return;
+            }
+            struct ::io_uring_buf_reg reg {};
+            reg.ring_addr = (std::uint64_t)_ring;
+            reg.ring_entries = kRecvBufCount;
+            reg.bgid = kRecvBufGroup;
+            if (_loop.registerOp(IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+                ::munmap(_ring, ringBytes);
+                _ring = nullptr;
+                return;
+            }
+            _bufs = std::make_unique<char[]>((std::size_t)kRecvBufCount * kRecvBufSize);
+            for (unsigned bid = 0; bid < kRecvBufCount; ++bid) {
+                put((std::uint16_t)bid);
+            }
+            publish();
+        }
+
+        ~RecvBufferRing() {
+            if (!_ring) {
+                return;
+            }
+            struct ::io_uring_buf_reg reg {};
+            reg.bgid = kRecvBufGroup;
+            _loop.registerOp(IORING_UNREGISTER_PBUF_RING, &reg, 1);
+            ::munmap(_ring, kRecvBufCount * sizeof(struct ::io_uring_buf));
+        }
+
+        bool isValid() const noexcept {
+            return _ring != nullptr;
+        }
+
+        std::span<char> buffer(std::uint16_t bid, std::size_t len) const noexcept {
+            return {_bufs.get() + (std::size_t)bid * kRecvBufSize, len};
+        }
+
+        /**
+         * @brief 归还一块缓冲; 有等缓冲的请求则全部叫醒
+         */
+        void recycle(std::uint16_t bid) {
+            put(bid);
+            publish();
+            ++_available;
+            if (!_starved.empty()) {
+                auto starved = std::exchange(_starved, {}); // 叫醒时可能又登记进来
+                for (auto *waiter : starved) {
+                    waiter->_wake(waiter);
+                }
+            }
+        }
+
+        /**
+         * @brief 内核从环里取走了一块缓冲 (完成事件带 IORING_CQE_F_BUFFER)
+         */
+        void consumed() noexcept {
+            --_available;
+        }
+
+        /**
+         * @brief 收到 -ENOBUFS 后调用: 按记账环里还有缓冲 (归还与取走的完成事件交错) 则返回 false, 应立即重挂;
+         *        否则登记 waiter, 等下一次 recycle, 不再每次重挂都立即以 -ENOBUFS 完成而空转
+         */
+        bool waitBuffer(BufferWaiter &waiter) {
+            if (_available > 0) {
+                return false;
+            }
+            _starved.push_back(&waiter);
+            return true;
+        }
+
+        void cancelWait(BufferWaiter &waiter) noexcept {
+            std::erase(_starved, &waiter);
+        }
+
+    private:
+        void put(std::uint16_t bid) noexcept {
+            // 不能用 _ring->bufs: C++ 下 __DECLARE_FLEX_ARRAY 的空结构体占位会把它挪到偏移 8,
+            // 而内核从偏移 0 开始读 (tail 与 bufs[0].resv 重叠)
+            auto *bufs = reinterpret_cast<struct ::io_uring_buf *>(_ring);
+            auto &buf = bufs[_tail & (kRecvBufCount - 1)];
+            buf.addr = (std::uint64_t)(_bufs.get() + (std::size_t)bid * kRecvBufSize);
+            buf.len = kRecvBufSize;
+            buf.bid = bid;
+            ++_tail;
+        }
+
+        void publish() noexcept {
+            std::atomic_ref<std::uint16_t>(_ring->tail).store(_tail, std::memory_order_release);
+        }
+
+        UringLoop &_loop;
+        struct ::io_uring_buf_ring *_ring = nullptr;
+        std::unique_ptr<char[]> _bufs;
+        std::uint16_t _tail = 0;
+        int _available = kRecvBufCount; // 环里还剩的缓冲 (按完成事件记账)
+        std::vector<BufferWaiter *> _starved; // 等缓冲的请求
+    };
+
+    /**
+     * @brief multishot recv 用的缓冲环, 第一次使用时创建; 不支持返回 nullptr
+     */
+    RecvBufferRing *recvBuffers() {
+        if (!_recvBufs) {
+            _recvBufs = std::make_unique<RecvBufferRing>(*this);
+        }
+        return _recvBufs->isValid() ? _recvBufs.get() : nullptr;
+    }
+
+    /**
+     * @brief 单次请求的等待者: 挂起时把预先填好的 sqe 放进 SQ, 完成后恢复协程
+     * @return co_await 的结果为 cqe->res (失败为 -errno)
+     */
+    struct Awaiter : UringRequest {
+        explicit Awaiter(struct ::io_uring_sqe const &sqe,
+                         struct ::__kernel_timespec ts = {}) noexcept
+            : _sqe(sqe)
+            , _ts(ts)
+        {
+            _complete = [](UringRequest *self, int res, std::uint32_t) {
+                auto *awaiter = static_cast<Awaiter *>(self);
+                awaiter->_res = res;
+                awaiter->_coroutine.resume();
+            };
+        }
+
+        Awaiter(Awaiter &&) = delete;
+
+        /**
+         * @brief 等待者的取消令牌被触发: 提交 ASYNC_CANCEL, 请求以 -ECANCELED 完成后照常恢复;
+         *        只能在提交请求的线程上触发
+         */
+        struct Canceller {
+            void operator()() const {
+                assert(_self->_loop->isCurrent() && "取消令牌须在等待者所在的线程上触发");
+                _self->_loop->cancel(_self);
+            }
+
+            Awaiter *_self;
+        };
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class P>
+        bool await_suspend(std::coroutine_handle<P> coroutine) {
+            if constexpr (HasStopToken<P>) {
+                auto const &token = coroutine.promise()._stopToken;
+                if (token.stop_requested()) {
+                    _res = -ECANCELED;
+                    return false;
+                }
+                submit(coroutine);
+                if (token.stop_possible()) {
+                    _stopCallback.emplace(token, Canceller {this});
+                }
+            } else {
+                submit(coroutine);
+            }
+            return true;
+        }
+
+        int await_resume() const noexcept {
+            return _res;
+        }
+
+        void submit(std::coroutine_handle<> coroutine) {
+            _coroutine = coroutine;
+            if (_sqe.opcode == IORING_OP_TIMEOUT) {
+                _sqe.addr = (std::uint64_t)&_ts; // 时间结构要活到提交时, 放在等待者里
+            }
+            _loop = &UringLoop::get();
+            _loop->submit(_sqe, this);
+        }
+
+        struct ::io_uring_sqe _sqe;
+        struct ::__kernel_timespec _ts {};
+        std::coroutine_handle<> _coroutine;
+        UringLoop *_loop = nullptr; // 提交请求的循环
+        int _res = 0;
+        std::optional<std::stop_callback<Canceller>> _stopCallback;
+    };
+
+    static struct ::io_uring_sqe prepare(
+        std::uint8_t opcode, int fd, int fixedIndex,
+        void const *addr, std::uint32_t len, std::uint64_t off
+    ) noexcept {
+        struct ::io_uring_sqe sqe {};
+        sqe.opcode = opcode;
+        if (fixedIndex >= 0) {
+            sqe.fd = fixedIndex;
+            sqe.flags |= IOSQE_FIXED_FILE;
+        } else {
+            sqe.fd = fd;
+        }
+        sqe.addr = (std::uint64_t)addr;
+        sqe.len = len;
+        sqe.off = off;
+        return sqe;
+    }
+
+    /**
+     * @param fixedIndex registerFile 返回的下标, -1 表示不用注册文件
+     */
+    static Awaiter read(int fd, std::span<char> buf, int fixedIndex = -1) noexcept {
+        return Awaiter(prepare(IORING_OP_READ, fd, fixedIndex, buf.data(),
+                               (std::uint32_t)buf.size(), (std::uint64_t)-1));
+    }
+
+    static Awaiter write(int fd, std::span<char const> buf, int fixedIndex = -1) noexcept {
+        return Awaiter(prepare(IORING_OP_WRITE, fd, fixedIndex, buf.data(),
+                               (std::uint32_t)buf.size(), (std::uint64_t)-1));
+    }
+
+    /**
+     * @brief 分散读 / 聚集写; iov 数组要活到请求完成 (放在协程帧里即可)
+     */
+    static Awaiter readv(int fd, std::span<struct ::iovec const> iov, int fixedIndex = -1) noexcept {
+        return Awaiter(prepare(IORING_OP_READV, fd, fixedIndex, iov.data(),
+                               (std::uint32_t)iov.size(), (std::uint64_t)-1));
+    }
+
+    static Awaiter writev(int fd, std::span<struct ::iovec const> iov, int fixedIndex = -1) noexcept {
+        return Awaiter(prepare(IORING_OP_WRITEV, fd, fixedIndex, iov.data(),
+                               (std::uint32_t)iov.size(), (std::uint64_t)-1));
+    }
+
+    /**
+     * @brief 读到已注册缓冲区 (registerBuffers) 的第 bufIndex 块中
+     */
+    static Awaiter readFixed(int fd, std::span<char> buf, std::uint16_t bufIndex,
+                             int fixedIndex = -1) noexcept {
+        auto sqe = prepare(IORING_OP_READ_FIXED, fd, fixedIndex, buf.data(),
+                           (std::uint32_t)buf.size(), (std::uint64_t)-1);
+        sqe.buf_index = bufIndex;
+        return Awaiter(sqe);
+    }
+
+    static Awaiter writeFixed(int fd, std::span<char const> buf, std::uint16_t bufIndex,
+                              int fixedIndex = -1) noexcept {
+        auto sqe = prepare(IORING_OP_WRITE_FIXED, fd, fixedIndex, buf.data(),
+                           (std::uint32_t)buf.size(), (std::uint64_t)-1);
+        sqe.buf_index = bufIndex;
+        return Awaiter(sqe);
+    }
+
+    static Awaiter connect(int fd, struct ::sockaddr const *addr, socklen_t len,
+                           int fixedIndex = -1) noexcept {
+        return Awaiter(prepare(IORING_OP_CONNECT, fd, fixedIndex, addr, 0, len));
+    }
+
+    /**
+     * @brief 接受一个连接, 新 fd 已是非阻塞的
+     */
+    static Awaiter accept(int fd, int fixedIndex = -1) noexcept {
+        auto sqe = prepare(IORING_OP_ACCEPT, fd, fixedIndex, nullptr, 0, 0);
+        sqe.accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        return Awaiter(sqe);
+    }
+
+    /**
+     * @brief 等待 fd 就绪 (单次 poll)
+     */
+    static Awaiter poll(int fd, std::uint32_t events, int fixedIndex = -1) noexcept {
+        auto sqe = prepare(IORING_OP_POLL_ADD, fd, fixedIndex, nullptr, 0, 0);
+        sqe.poll32_events = events;
+        return Awaiter(sqe);
+    }
+
+    /**
+     * @brief 计时器: 由内核计时, 到期后恢复 (结果为 -ETIME)
+     */
+    static Awaiter sleepFor(std::chrono::nanoseconds duration) noexcept {
+        struct ::__kernel_timespec ts {};
+        ts.tv_sec = duration.count() / 1'000'000'000;
+        ts.tv_nsec = duration.count() % 1'000'000'000;
+        return Awaiter(prepare(IORING_OP_TIMEOUT, -1, -1, nullptr, 1, 0), ts);
+    }
+
+private:
+    int _ringFd = -1;
+    void *_ring = nullptr;
+    std::size_t _ringSize = 0;
+    struct ::io_uring_sqe *_sqes = nullptr;
+    std::size_t _sqesSize = 0;
+    unsigned *_sqHead = nullptr;
+    unsigned *_sqTail = nullptr;
+    unsigned _sqMask = 0;
+    unsigned _sqEntries = 0;
+    unsigned _localTail = 0; // 本地累积的 SQ tail, 提交时才发布
+    unsigned *_cqHead = nullptr;
+    unsigned *_cqTail = nullptr;
+    unsigned _cqMask = 0;
+    struct ::io_uring_cqe *_cqes = nullptr;
+    bool _extArg = false;
+    std::size_t _inflight = 0; // 还未最终完成的请求数 (不含 epoll 的监听)
+    std::vector<int> _freeFixedFiles;
+    std::vector<struct ::iovec> _fixedBuffers; // registerBuffers 注册的缓冲区 (下标即 buf_index)
+    std::unique_ptr<RecvBufferRing> _recvBufs;
+    UringRequest _epollWatch;
+    bool _epollWatched = false;
+
+    static inline thread_local UringLoop *tlsCurrent = nullptr;
+};
+
+/**
+ * @brief multishot recv: 一次提交, 内核持续把收到的数据放进缓冲环里的缓冲
+ *
+ * `co_await stream.next()` 返回一段数据 (std::span<char const>), 在下一次 next() 前有效;
+ * 返回空 span 表示对端关闭或出错 (见 error()).
+ * 缓冲环不可用时退化为每次 next() 一个普通 recv.
+ */
+class UringRecvStream {
+    struct Chunk {
+        std::uint16_t bid;
+        std::uint32_t len;
+    };
+
+    /**
+     * @brief 请求状态单独申请: 流析构时若请求还在内核里, 由它自己等到最后一个完成事件再释放
+     */
+    struct State : UringRequest, UringLoop::RecvBufferRing::BufferWaiter {
+        UringRecvStream *owner = nullptr; // 流析构后为 nullptr
+        std::vector<Chunk> ready;   // 已完成但还没被取走的数据 (环形)
+        std::size_t readyHead = 0;
+        std::size_t readyCount = 0;
+        std::coroutine_handle<> waiter;
+        int error = 0;
+        bool armed = false;
+        bool eof = false;
+        bool orphaned = false;
+        bool starved = false; // 缓冲用完, 在缓冲环上等归还
+
+        void push(Chunk chunk) {
+            ready[(readyHead + readyCount) % ready.size()] = chunk;
+            ++readyCount;
+        }
+
+        Chunk pop() noexcept {
+            Chunk chunk = ready[readyHead];
+            readyHead = (readyHead + 1) % ready.size();
+            --readyCount;
+            return chunk;
+        }
+    };
+
+public:
+    explicit UringRecvStream(int fd, int fixedIndex = -1)
+        : _fd(fd)
+        , _fixedIndex(fixedIndex)
+        , _bufs(UringLoop::get().recvBuffers())
+        , _state(std::make_unique<State>())
+    {
+        _state->ready.resize(_bufs ? UringLoop::kRecvBufCount : 1);
+        _state->owner = this;
+        _state->_complete = &onComplete;
+        _state->_wake = &onBuffer;
+    }
+
+    UringRecvStream(UringRecvStream &&) = delete;
+
+    ~UringRecvStream() {
+        releaseHeld();
+        if (_state->starved) {
+            _bufs->cancelWait(*_state);
+        }
+        while (_bufs && _state->readyCount) { // 收到了还没取走的, 缓冲都要还回环里
+            _bufs->recycle(_state->pop().bid);
+        }
+        if (_state->armed) { // 还在内核里: 取消, 由最后一个完成事件释放状态
+            UringLoop::get().cancel(_state.get());
+            _state->orphaned = true;
+            _state->owner = nullptr;
+            _state.release();
+        }
+    }
+
+    int error() const noexcept {
+        return _state->error;
+    }
+
+    struct NextAwaiter {
+        bool await_ready() {
+            _self.releaseHeld();
+            return _self._state->readyCount || _self._state->eof;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) {
+            _self._state->waiter = coroutine;
+            _self.arm();
+        }
+
+        std::span<char const> await_resume() {
+            auto &state = *_self._state;
+            state.waiter = nullptr;
+            if (!state.readyCount) {
+                return {};
+            }
+            Chunk chunk = state.pop();
+            if (_self._bufs) {
+                _self._held = chunk.bid;
+                return _self._bufs->buffer(chunk.bid, chunk.len);
+            }
+            return {_self._fallback.data(), chunk.len};
+        }
+
+        UringRecvStream &_self;
+    };
+
+    NextAwaiter next() noexcept {
+        return {*this};
+    }
+
+private:
+    static void onComplete(UringRequest *self, int res, std::uint32_t flags) {
+        auto &state = *static_cast<State *>(self);
+        auto *bufs = UringLoop::get().recvBuffers();
+        if (!(flags & IORING_CQE_F_MORE)) {
+            state.armed = false;
+        }
+        if ((flags & IORING_CQE_F_BUFFER) && bufs) {
+            bufs->consumed();
+        }
+        if (state.orphaned) { // 流已析构: 只归还缓冲
+            if ((flags & IORING_CQE_F_BUFFER) && bufs) {
+                bufs->recycle((std::uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT));
+            }
+            if (!state.armed) {
+                delete &state;
+            }
+            return;
+        }
+        if (res <= 0 && (flags & IORING_CQE_F_BUFFER) && bufs) { // 取了缓冲却没有数据, 直接还回去
+            bufs->recycle((std::uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT));
+        }
+        if (res > 0) {
+            std::uint16_t bid = (flags & IORING_CQE_F_BUFFER)
+                ? (std::uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT) : 0;
+            state.push({bid, (std::uint32_t)res});
+        } else if (res == 0) {
+            state.eof = true;
+        } else if (res != -ENOBUFS && res != -ECANCELED) { // 缓冲用完只需重新挂
+            state.error = -res;
+            state.eof = true;
+        }
+        if (state.waiter && (state.readyCount || state.eof)) {
+            state.waiter.resume();
+        } else if (state.waiter && !state.armed) { // multishot 被终止, 重新挂; 缓冲用完则等归还再挂
+            if (res == -ENOBUFS && bufs && bufs->waitBuffer(state)) {
+                state.starved = true;
+            } else {
+                state.owner->arm();
+            }
+        }
+    }
+
+    /**
+     * @brief 缓冲环上有缓冲归还了: 还有人在等就重新挂上
+     */
+    static void onBuffer(UringLoop::RecvBufferRing::BufferWaiter *self) {
+        auto &state = static_cast<State &>(*self);
+        state.starved = false;
+        if (state.waiter) {
+            state.owner->arm();
+        }
+    }
+
+    struct ::io_uring_sqe makeSqe() noexcept {
+        if (_bufs) {
+            auto sqe = UringLoop::prepare(IORING_OP_RECV, _fd, _fixedIndex, nullptr, 0, 0);
+            sqe.ioprio = IORING_RECV_MULTISHOT;
+            sqe.flags |= IOSQE_BUFFER_SELECT;
+            sqe.buf_group = UringLoop::kRecvBufGroup;
+            return sqe;
+        }
+        return UringLoop::prepare(IORING_OP_RECV, _fd, _fixedIndex, _fallback.data(),
+                                  (std::uint32_t)_fallback.size(), 0);
+    }
+
+    void arm() {
+        if (_state->armed || _state->eof || _state->starved) { // 等缓冲时由 onBuffer 来挂
+            return;
+        }
+        UringLoop::get().submit(makeSqe(), _state.get());
+        _state->armed = true;
+    }
+
+    void releaseHeld() noexcept {
+        if (_held >= 0) {
+            _bufs->recycle((std::uint16_t)_held);
+            _held = -1;
+        }
+    }
+
+    int _fd;
+    int _fixedIndex;
+    UringLoop::RecvBufferRing *_bufs;
+    std::unique_ptr<State> _state;
+    int _held = -1; // 正借给调用者的缓冲
+    std::vector<char> _fallback = std::vector<char>(_bufs ? 0 : 16 * 1024);
+};
+
+} // namespace HX
+
+#endif // !_HX_URING_LOOP_H_
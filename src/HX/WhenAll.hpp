@@ -0,0 +1,202 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-17 14:31:09
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_WHEN_ALL_H_
+#define _HX_WHEN_ALL_H_
+
+#include <coroutine>
+#include <exception>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Task.hpp"
+#include "Uninitialized.hpp"
+#include "ReturnPreviousTask.hpp"
+
+namespace HX {
+
+/**
+ * @brief Task 的结果类型
+ */
+template <class T>
+struct TaskResult;
+
+template <class T, class P>
+struct TaskResult<Task<T, P>> {
+    using Type = T;
+};
+
+/**
+ * @brief when_all 的控制块: 放在等待者的协程帧里, 不额外申请内存
+ */
+struct WhenAllCtlBlock {
+    std::size_t _count {};                // 还没结束的子任务数
+    std::coroutine_handle<> _previous {}; // 等待全部结束的协程
+    std::exception_ptr _exception {};     // 第一个异常
+};
+
+/**
+ * @brief when_all 的结果槽: 有子任务抛异常时没有人取走结果, 析构时销毁已放进来的值
+ */
+template <class T>
+struct WhenAllResult {
+    WhenAllResult() noexcept = default;
+
+    WhenAllResult &operator=(WhenAllResult &&) = delete;
+
+    ~WhenAllResult() {
+        if (_filled) {
+            _val.moveVal();
+        }
+    }
+
+    template <class... Ts>
+    void putVal(Ts &&...args) {
+        _val.putVal(std::forward<Ts>(args)...);
+        _filled = true;
+    }
+
+    auto moveVal() {
+        _filled = false;
+        return _val.moveVal();
+    }
+
+    Uninitialized<T> _val;
+    bool _filled = false;
+};
+
+struct WhenAllAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    /**
+     * @brief 依次启动子任务: 前面的直接恢复 (跑到第一次挂起为止), 最后一个对称转移过去;
+     *        最后结束的子任务负责转回等待者.
+     *        等待者的取消令牌传给没有单独指定令牌的子任务
+     */
+    template <class P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> coroutine) const {
+        if (_tasks.empty()) {
+            return coroutine;
+        }
+        _control._previous = coroutine;
+        if constexpr (HasStopToken<P>) {
+            for (auto const &task : _tasks) {
+                task._coroutine.promise()._stopToken = coroutine.promise()._stopToken;
+            }
+        }
+        for (auto const &task : _tasks.first(_tasks.size() - 1)) {
+            task._coroutine.resume();
+        }
+        return _tasks.back()._coroutine;
+    }
+
+    void await_resume() const {
+        if (_control._exception) [[unlikely]] {
+            std::rethrow_exception(_control._exception);
+        }
+    }
+
+    WhenAllCtlBlock &_control;
+    std::span<ReturnPreviousTask const> _tasks;
+};
+
+template <class T, class P>
+ReturnPreviousTask whenAllHelper(
+    Task<T, P> const &task,
+    WhenAllCtlBlock &control,
+    WhenAllResult<T> &result
+) {
+    try {
+        result.putVal((co_await task, NonVoidHelper<>()));
+    } catch (...) {
+        if (!control._exception) {
+            control._exception = std::current_exception();
+        }
+    }
+    --control._count;
+    if (control._count == 0) {
+        co_return control._previous;
+    }
+    co_return nullptr;
+}
+
+template <std::size_t... Is, class... Ts, class... Ps>
+Task<std::tuple<typename NonVoidHelper<Ts>::Type...>> whenAllImpl(
+    std::index_sequence<Is...>,
+    Task<Ts, Ps>... tasks
+) {
+    WhenAllCtlBlock control {sizeof...(Ts)};
+    std::tuple<WhenAllResult<Ts>...> results;
+    ReturnPreviousTask helpers[] {whenAllHelper(tasks, control, std::get<Is>(results))...};
+    co_await WhenAllAwaiter(control, helpers);
+    co_return std::tuple<typename NonVoidHelper<Ts>::Type...>(
+        std::get<Is>(results).moveVal()...);
+}
+
+/**
+ * @brief 并发运行全部子任务 (在当前线程上), 全部结束后返回各自的结果
+ *
+ * 结果放在当前协程帧里的 Uninitialized 中; void 的结果为 NonVoidHelper<>.
+ * 有子任务抛异常时, 仍等全部结束, 销毁其余子任务的结果, 再重新抛出第一个异常.
+ * 没有单独指定取消令牌的子任务继承当前协程的令牌.
+ * @return std::tuple<结果...>
+ */
+template <class... Ts, class... Ps>
+    requires(sizeof...(Ts) != 0)
+auto when_all(Task<Ts, Ps>... tasks) {
+    return whenAllImpl(std::make_index_sequence<sizeof...(Ts)>(), std::move(tasks)...);
+}
+
+/**
+ * @brief 并发运行 range 中的全部子任务, 全部结束后按顺序返回结果
+ *        (先数个数再遍历一遍, 所以要求 forward_range, 同 when_any)
+ * @return std::vector<T>; 子任务为 Task<void> 时返回 Task<void>
+ */
+template <std::ranges::forward_range R,
+          class T = typename TaskResult<std::ranges::range_value_t<R>>::Type>
+Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> when_all(R tasks) {
+    std::size_t n = (std::size_t)std::ranges::distance(tasks);
+    WhenAllCtlBlock control {n};
+    std::vector<WhenAllResult<T>> results(n);
+    std::vector<ReturnPreviousTask> helpers;
+    helpers.reserve(n);
+    std::size_t i = 0;
+    for (auto const &task : tasks) {
+        helpers.push_back(whenAllHelper(task, control, results[i++]));
+    }
+    co_await WhenAllAwaiter(control, helpers);
+    if constexpr (!std::is_void_v<T>) {
+        std::vector<T> res;
+        res.reserve(n);
+        for (auto &result : results) {
+            res.push_back(result.moveVal());
+        }
+        co_return res;
+    }
+}
+
+} // namespace HX
+
+#endif // !_HX_WHEN_ALL_H_
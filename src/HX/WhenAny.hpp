@@ -0,0 +1,296 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-17 15:12:40
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_WHEN_ANY_H_
+#define _HX_WHEN_ANY_H_
+
+#include <array>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "Task.hpp"
+#include "Uninitialized.hpp"
+#include "FrameAllocator.hpp"
+#include "WhenAll.hpp"
+
+namespace HX {
+
+/**
+ * @brief when_any 的控制块 (堆上, 引用计数)
+ *
+ * 输掉的子任务被分离, 可能比等待者活得久, 所以控制块不能放在等待者的帧里;
+ * 等待者与每个还没结束的辅助协程各持有一份引用, 最后一个释放者负责 delete.
+ * 只在当前线程上使用, 计数不需要原子操作.
+ * @tparam R 结果类型
+ */
+template <class R>
+struct WhenAnyCtlBlock {
+    static constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+    void release() noexcept {
+        if (--_refs == 0) {
+            if (_index != kNone && !_exception && !_taken) {
+                _result.moveVal(); // 等待者被销毁而没有取走结果
+            }
+            delete this;
+        }
+    }
+
+    /**
+     * @brief 子任务结束时调用; 第一个结束的成为胜者
+     * @return 本次调用之后需要转去恢复的协程 (可能为 nullptr)
+     */
+    template <class... Args>
+    std::coroutine_handle<> finish(std::size_t index, std::exception_ptr exception, Args &&...args) {
+        std::coroutine_handle<> next = nullptr;
+        if (_index == kNone) {
+            _index = index;
+            _exception = std::move(exception);
+            if (!_exception) {
+                _result.putVal(std::forward<Args>(args)...);
+            }
+            _stopSource.request_stop(); // 取消输家 (它们的等待在下一轮由循环恢复)
+            if (!_starting) { // 还在逐个启动时由 WhenAnyAwaiter 自己继续
+                next = _previous;
+            }
+        }
+        release();
+        return next;
+    }
+
+    std::size_t _refs;                 // 等待者 + 还没结束的辅助协程
+    std::size_t _index = kNone;        // 胜者下标
+    bool _starting = true;             // 是否仍在 await_suspend 里启动子任务
+    bool _taken = false;               // 结果是否已被取走
+    std::coroutine_handle<> _previous; // 等待者
+    std::exception_ptr _exception;     // 胜者的异常
+    Uninitialized<R> _result;          // 胜者的结果
+    std::stop_source _stopSource;      // 子任务的取消令牌来源, 有胜者时触发
+    std::optional<std::stop_callback<StopForwarder>> _parentLink; // 等待者被取消时一并取消子任务
+};
+
+/**
+ * @brief when_any 的辅助协程: 持有子任务, 结束时自行销毁 (输了也不需要任何人回收)
+ */
+struct WhenAnyHelperTask {
+    struct promise_type {
+        auto initial_suspend() noexcept {
+            return std::suspend_always();
+        }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> coroutine
+            ) const noexcept {
+                auto next = coroutine.promise()._next;
+                coroutine.destroy();
+                return next ? next : std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        auto final_suspend() noexcept {
+            return FinalAwaiter();
+        }
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+
+        void return_value(std::coroutine_handle<> next) noexcept {
+            _next = next;
+        }
+
+        WhenAnyHelperTask get_return_object() {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+#if !HX_NO_FRAME_POOL
+        static void *operator new(std::size_t size) {
+            return HX::FrameAllocator::allocate(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept {
+            HX::FrameAllocator::deallocate(ptr, size);
+        }
+#endif
+
+        std::coroutine_handle<> _next {};
+        std::stop_token _stopToken {}; // 传给 co_await 的子任务
+    };
+
+    std::coroutine_handle<promise_type> _coroutine; // 启动前归创建者, 启动后自行销毁
+};
+
+/**
+ * @brief 依次启动辅助协程; 有胜者后剩下的不再启动, 直接销毁
+ */
+template <class R>
+struct WhenAnyAwaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <class P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> coroutine) const {
+        _control->_previous = coroutine;
+        if constexpr (HasStopToken<P>) {
+            auto const &token = coroutine.promise()._stopToken;
+            if (token.stop_possible()) {
+                _control->_parentLink.emplace(token, StopForwarder {&_control->_stopSource});
+            }
+        }
+        for (auto helper : _helpers) {
+            if (_control->_index == WhenAnyCtlBlock<R>::kNone) {
+                helper.promise()._stopToken = _control->_stopSource.get_token();
+                helper.resume();
+            } else {
+                helper.destroy(); // 还没启动, 连同其中的子任务一起销毁
+                --_control->_refs;
+            }
+        }
+        _control->_starting = false;
+        if (_control->_index != WhenAnyCtlBlock<R>::kNone) { // 启动时就有人同步完成了
+            return coroutine;
+        }
+        return std::noop_coroutine();
+    }
+
+    std::size_t await_resume() const {
+        if (_control->_exception) [[unlikely]] {
+            std::rethrow_exception(_control->_exception);
+        }
+        return _control->_index;
+    }
+
+    WhenAnyCtlBlock<R> *_control;
+    std::span<std::coroutine_handle<WhenAnyHelperTask::promise_type> const> _helpers;
+};
+
+/**
+ * @brief 等待者取完结果后释放控制块 (包括异常路径)
+ */
+template <class R>
+struct WhenAnyCtlGuard {
+    WhenAnyCtlGuard &operator=(WhenAnyCtlGuard &&) = delete;
+
+    ~WhenAnyCtlGuard() {
+        if (_control->_index == WhenAnyCtlBlock<R>::kNone) { // 等待者在结果出来前被销毁
+            _control->_previous = nullptr;
+        }
+        _control->_parentLink.reset();
+        _control->release();
+    }
+
+    WhenAnyCtlBlock<R> *_control;
+};
+
+/**
+ * @param tag 构造结果时放在最前面的参数 (variant 用 std::in_place_index<I>)
+ */
+template <class R, class T, class P, class... Tag>
+WhenAnyHelperTask whenAnyHelper(
+    Task<T, P> task,
+    WhenAnyCtlBlock<R> *control,
+    std::size_t index,
+    Tag... tag
+) {
+    std::exception_ptr exception;
+    try {
+        auto &&res = (co_await task, NonVoidHelper<>());
+        if (control->_index == WhenAnyCtlBlock<R>::kNone) {
+            co_return control->finish(index, nullptr, tag..., std::forward<decltype(res)>(res));
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    co_return control->finish(index, std::move(exception));
+}
+
+template <std::size_t... Is, class... Ts, class... Ps>
+Task<std::variant<typename NonVoidHelper<Ts>::Type...>> whenAnyImpl(
+    std::index_sequence<Is...>,
+    Task<Ts, Ps>... tasks
+) {
+    using R = std::variant<typename NonVoidHelper<Ts>::Type...>;
+    auto *control = new WhenAnyCtlBlock<R> {sizeof...(Ts) + 1};
+    WhenAnyCtlGuard<R> guard {control};
+    std::array<std::coroutine_handle<WhenAnyHelperTask::promise_type>, sizeof...(Ts)> helpers {
+        whenAnyHelper(std::move(tasks), control, Is, std::in_place_index<Is>)._coroutine...};
+    co_await WhenAnyAwaiter<R> {control, helpers};
+    control->_taken = true;
+    co_return control->_result.moveVal();
+}
+
+/**
+ * @brief 并发运行全部子任务 (在当前线程上), 第一个结束的决定结果
+ *
+ * 有胜者时通过取消令牌取消输掉的子任务, 输家被分离: 观察到取消后运行到结束, 自行销毁, 结果丢弃;
+ * 它们持有的计时器/文件等待仍在各自的帧里, 不会悬空.
+ * 当前协程被取消时, 全部子任务一并被取消 (没有单独指定令牌的子任务).
+ * 第一个结束的子任务抛了异常, 则重新抛出该异常.
+ * @return std::variant<结果...>, index() 即胜者下标; void 的结果为 NonVoidHelper<>
+ */
+template <class... Ts, class... Ps>
+    requires(sizeof...(Ts) != 0)
+auto when_any(Task<Ts, Ps>... tasks) {
+    return whenAnyImpl(std::make_index_sequence<sizeof...(Ts)>(), std::move(tasks)...);
+}
+
+/**
+ * @brief range 版本: 子任务类型相同; range 为空时没有人能结束它, 抛 std::invalid_argument
+ * @return {胜者下标, 结果}
+ */
+template <std::ranges::forward_range Rg,
+          class T = typename TaskResult<std::ranges::range_value_t<Rg>>::Type>
+Task<std::pair<std::size_t, typename NonVoidHelper<T>::Type>> when_any(Rg tasks) {
+    using R = typename NonVoidHelper<T>::Type;
+    std::size_t n = (std::size_t)std::ranges::distance(tasks);
+    if (n == 0) [[unlikely]] {
+        throw std::invalid_argument("HX::when_any: empty range");
+    }
+    auto *control = new WhenAnyCtlBlock<R> {n + 1};
+    WhenAnyCtlGuard<R> guard {control};
+    std::vector<std::coroutine_handle<WhenAnyHelperTask::promise_type>> helpers;
+    helpers.reserve(n);
+    std::size_t i = 0;
+    for (auto &task : tasks) {
+        helpers.push_back(whenAnyHelper(std::move(task), control, i++)._coroutine);
+    }
+    std::size_t index = co_await WhenAnyAwaiter<R> {control, helpers};
+    control->_taken = true;
+    co_return std::pair<std::size_t, R>(index, control->_result.moveVal());
+}
+
+} // namespace HX
+
+#endif // !_HX_WHEN_ANY_H_
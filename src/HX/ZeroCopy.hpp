@@ -0,0 +1,191 @@
+#pragma once
+/*
+ * Copyright Zero One Star. All rights reserved.
+ *
+ * @Author: Heng_Xin
+ * @Date: 2026-10-16 19:05:31
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *	  https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _HX_ZERO_COPY_H_
+#define _HX_ZERO_COPY_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <span>
+#include <system_error>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "Task.hpp"
+#include "AsyncFile.hpp"
+#include "EpollLoop.hpp"
+
+namespace HX {
+
+/**
+ * @brief 零拷贝发送 (SO_ZEROCOPY + send(MSG_ZEROCOPY)): 内核直接引用调用方的页面, 不拷进 socket 缓冲区
+ *
+ * 内核发完 (对端确认) 后才归还页面, 完成通知放在 socket 的错误队列里 (EPOLLERR);
+ * send 在数据全部交给内核之后, 继续等到这次调用的全部通知都到齐才返回,
+ * 所以 co_await 返回之后缓冲区就可以复用或释放了.
+ * 小于阈值的发送直接走拷贝的 writeAll (零拷贝要锁页、读通知, 小块反而更慢);
+ * 内核不支持, 或走 io_uring (socket 不在 epoll 上) 时全部走拷贝.
+ * 同一个 socket 上同时只能有一个 send 在进行 (同 writeAll).
+ */
+class ZeroCopySender {
+public:
+    static constexpr std::size_t kDefaultThreshold = 16 * 1024;
+
+    /**
+     * @param threshold 小于这么多字节的发送走拷贝
+     */
+    explicit ZeroCopySender(AsyncFile &file, std::size_t threshold = kDefaultThreshold)
+        : _file(file)
+        , _threshold(threshold)
+    {
+        int on = 1;
+        _enabled = file.getState()
+            && ::setsockopt(file.getFd(), SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == 0;
+    }
+
+    ZeroCopySender &operator=(ZeroCopySender &&) = delete;
+
+    /**
+     * @brief 是否真的在用零拷贝
+     */
+    bool enabled() const noexcept {
+        return _enabled;
+    }
+
+    /**
+     * @brief 内核是否退回过拷贝 (如发往本机回环): 此时零拷贝只有额外开销, 调用方可以换回 writeAll
+     */
+    bool kernelCopied() const noexcept {
+        return _kernelCopied;
+    }
+
+    /**
+     * @brief 把 data 全部发完, 并等到内核不再引用它; 出错 (包括被取消) 抛 std::system_error,
+     *        抛出之前同样会等已交给内核的部分完成
+     * @return 发送的字节数
+     */
+    Task<std::size_t> send(std::span<char const> data) {
+        if (!_enabled || data.size() < _threshold) {
+            co_return co_await _file.writeAll({data.data(), data.size()});
+        }
+        auto *state = _file.getState();
+        std::uint32_t first = _nextId; // 本次调用的通知编号 [first, _nextId)
+        int flags = MSG_ZEROCOPY;
+        int error = 0;
+        std::size_t total = 0;
+        while (total < data.size()) {
+            ssize_t len = ::send(_file.getFd(), data.data() + total, data.size() - total, flags);
+            if (len >= 0) {
+                total += (std::size_t)len;
+                if (flags & MSG_ZEROCOPY) {
+                    ++_nextId; // 内核给每次成功的零拷贝发送分配一个编号
+                }
+            } else if (errno == EAGAIN) {
+                state->clearReady(EPOLLOUT);
+                if (!co_await state->waitWritable()) {
+                    error = ECANCELED;
+                    break;
+                }
+            } else if (errno == ENOBUFS) { // 锁定的页面超出了 optmem 限额
+                if (_nextId != first) {
+                    co_await reap(first, _nextId); // 等前面的归还了再继续
+                    first = _nextId;
+                } else {
+                    flags = 0; // 一页都锁不了, 剩下的拷贝发送
+                }
+            } else if (errno != EINTR) {
+                error = errno;
+                break;
+            }
+        }
+        co_await reap(first, _nextId);
+        if (error) {
+            throw std::system_error(error, std::system_category());
+        }
+        co_return total;
+    }
+
+private:
+    /**
+     * @brief 等编号 [first, end) 的完成通知全部到齐 (不响应取消: 内核还在引用缓冲区)
+     */
+    Task<void> reap(std::uint32_t first, std::uint32_t end) {
+        std::uint32_t pending = end - first;
+        while (pending) {
+            _file.getState()->clearErrorQueue();
+            pending -= std::min(pending, drain(first, end));
+            if (pending) {
+                co_await _file.getState()->waitErrorQueue();
+            }
+        }
+    }
+
+    /**
+     * @brief 读空错误队列
+     * @return 其中落在 [first, end) 里的编号个数
+     */
+    std::uint32_t drain(std::uint32_t first, std::uint32_t end) {
+        std::uint32_t window = end - first;
+        std::uint32_t done = 0;
+        while (true) {
+            alignas(struct ::cmsghdr) char control[128];
+            struct ::msghdr msg {};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (::recvmsg(_file.getFd(), &msg, MSG_ERRQUEUE) == -1) {
+                return done; // EAGAIN: 读空了
+            }
+            for (auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                bool recvErr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                    || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+                if (!recvErr) {
+                    continue;
+                }
+                auto *err = reinterpret_cast<struct ::sock_extended_err *>(CMSG_DATA(cmsg));
+                if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                    continue;
+                }
+                if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                    _kernelCopied = true;
+                }
+                // 通知是闭区间 [ee_info, ee_data], 与 [first, end) 求交 (编号按 32 位回绕)
+                std::uint32_t lo = err->ee_info;
+                std::uint32_t len = err->ee_data - lo + 1;
+                if (lo - first < window) {
+                    done += std::min(len, window - (lo - first));
+                } else if (first - lo < len) {
+                    done += std::min(len - (first - lo), window);
+                }
+            }
+        }
+    }
+
+    AsyncFile &_file;
+    std::size_t _threshold;
+    std::uint32_t _nextId = 0; // 下一次零拷贝发送的通知编号 (与内核的 sk_zckey 同步)
+    bool _enabled = false;
+    bool _kernelCopied = false;
+};
+
+} // namespace HX
+
+#endif // !_HX_ZERO_COPY_H_
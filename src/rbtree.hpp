@@ -1,8 +1,15 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <utility>
 
+/**
+ * @brief 侵入式红黑树: 节点 (RbNode) 嵌在 Value 里, 插入/删除不申请内存
+ *
+ * Value 需要继承 RbNode; 相同键值的节点按插入顺序排列 (新的在右边).
+ * 节点析构时若仍在树中会自动摘除, 对不在树中的节点 erase 是空操作.
+ */
 template <class Value, class Compare = std::less<Value>>
 struct RbTree {
     enum RbColor {
@@ -26,6 +33,13 @@ struct RbTree {
             }
         }
 
+        /**
+         * @brief 节点当前是否挂在某棵树上
+         */
+        bool isLinked() const noexcept {
+            return tree != nullptr;
+        }
+
         friend struct RbTree;
 
     private:
@@ -38,12 +52,44 @@ struct RbTree {
 
 private:
     RbNode *root;
+    RbNode *leftmost; // 缓存最左节点, front() 为 O(1)
+    std::size_t count;
     Compare comp;
 
     bool compare(RbNode *left, RbNode *right) const noexcept {
         return comp(static_cast<Value &>(*left), static_cast<Value &>(*right));
     }
 
+    static bool isRed(RbNode *node) noexcept {
+        return node != nullptr && node->color == RED;
+    }
+
+    static RbNode *minimum(RbNode *node) noexcept {
+        while (node->left != nullptr) {
+            node = node->left;
+        }
+        return node;
+    }
+
+    static RbNode *maximum(RbNode *node) noexcept {
+        while (node->right != nullptr) {
+            node = node->right;
+        }
+        return node;
+    }
+
+    static RbNode *successor(RbNode *node) noexcept {
+        if (node->right != nullptr) {
+            return minimum(node->right);
+        }
+        RbNode *parent = node->parent;
+        while (parent != nullptr && node == parent->right) {
+            node = parent;
+            parent = parent->parent;
+        }
+        return parent;
+    }
+
     void rotateLeft(RbNode *node) noexcept {
         RbNode *rightChild = node->right;
         node->right = rightChild->left;
@@ -139,157 +185,175 @@ private:
 
         RbNode *parent = nullptr;
         RbNode *current = root;
+        bool isLeft = false;
+        bool isLeftmost = true;
 
         while (current != nullptr) {
             parent = current;
-            if (compare(node, current)) {
+            isLeft = compare(node, current);
+            if (isLeft) {
                 current = current->left;
             } else {
                 current = current->right;
+                isLeftmost = false;
             }
         }
 
         node->parent = parent;
         if (parent == nullptr) {
             root = node;
-        } else if (compare(node, parent)) {
+        } else if (isLeft) {
             parent->left = node;
         } else {
             parent->right = node;
         }
+        if (isLeftmost) {
+            leftmost = node;
+        }
+        ++count;
 
         fixViolation(node);
     }
 
-    /* template <class Key> */
-    /* RbNode* doFind(Key &&key) const { */
-    /*     RbNode* current = root; */
-    /*     // Find the node to delete */
-    /*     while (current != nullptr) { */
-    /*         if (key_compare(key, current)) { */
-    /*             current = current->left; */
-    /*         } else { */
-    /*             current = current->right; */
-    /*         } */
-    /*     } */
-    /*     return nullptr; */
-    /* } */
-
-    /* void doErase(RbNode* node) noexcept { */
-    /*     RbNode* parent = nullptr; */
-    /*  */
-    /*     // Case 1: Node to delete has no children */
-    /*     if (node->left == nullptr && node->right == nullptr) { */
-    /*         if (node == root) { */
-    /*             root = nullptr; */
-    /*         } else { */
-    /*             if (node == parent->left) { */
-    /*                 parent->left = nullptr; */
-    /*             } else { */
-    /*                 parent->right = nullptr; */
-    /*             } */
-    /*         } */
-    /*         delete node; */
-    /*     } */
-    /*     // Case 2: Node to delete has one child */
-    /*     else if (node->left == nullptr || node->right == nullptr) { */
-    /*         RbNode* child = (node->left != nullptr) ? node->left : node->right; */
-    /*  */
-    /*         if (node == root) { */
-    /*             root = child; */
-    /*         } else { */
-    /*             if (node == parent->left) { */
-    /*                 parent->left = child; */
-    /*             } else { */
-    /*                 parent->right = child; */
-    /*             } */
-    /*         } */
-    /*         child->parent = parent; */
-    /*         delete node; */
-    /*     } */
-    /*     // Case 3: Node to delete has two children */
-    /*     else { */
-    /*         RbNode* successor = node->right; */
-    /*         while (successor->left != nullptr) { */
-    /*             successor = successor->left; */
-    /*         } */
-    /*         doErase(successor); */
-    /*     } */
-    /* } */
-
-    void doErase(RbNode *current) noexcept {
-        current->tree = nullptr;
-
-        RbNode *node = nullptr;
-        RbNode *child = nullptr;
-        RbColor color = RED;
-
-        if (current->left != nullptr && current->right != nullptr) {
-            RbNode *replace = current;
-            replace = replace->right;
-            while (replace->left != nullptr) {
-                replace = replace->left;
-            }
-
-            if (current != replace->parent) {
-                current->parent->left = replace->right;
-                replace->right = current->right;
-                current->right->parent = replace;
-            } else {
-                replace->parent = current;
-            }
+    /**
+     * @brief 用 child 替换 node 在父节点中的位置
+     */
+    void transplant(RbNode *node, RbNode *child) noexcept {
+        if (node->parent == nullptr) {
+            root = child;
+        } else if (node == node->parent->left) {
+            node->parent->left = child;
+        } else {
+            node->parent->right = child;
+        }
+        if (child != nullptr) {
+            child->parent = node->parent;
+        }
+    }
 
-            if (current == root) {
-                root = replace;
-            } else if (current->parent->left == current) {
-                current->parent->left = replace;
+    void fixErase(RbNode *node, RbNode *parent) noexcept {
+        while (node != root && !isRed(node)) {
+            if (node == parent->left) {
+                RbNode *sibling = parent->right;
+                if (isRed(sibling)) {
+                    sibling->color = BLACK;
+                    parent->color = RED;
+                    rotateLeft(parent);
+                    sibling = parent->right;
+                }
+                if (!isRed(sibling->left) && !isRed(sibling->right)) {
+                    sibling->color = RED;
+                    node = parent;
+                    parent = node->parent;
+                } else {
+                    if (!isRed(sibling->right)) {
+                        sibling->left->color = BLACK;
+                        sibling->color = RED;
+                        rotateRight(sibling);
+                        sibling = parent->right;
+                    }
+                    sibling->color = parent->color;
+                    parent->color = BLACK;
+                    sibling->right->color = BLACK;
+                    rotateLeft(parent);
+                    node = root;
+                    break;
+                }
             } else {
-                current->parent->right = replace;
+                RbNode *sibling = parent->left;
+                if (isRed(sibling)) {
+                    sibling->color = BLACK;
+                    parent->color = RED;
+                    rotateRight(parent);
+                    sibling = parent->left;
+                }
+                if (!isRed(sibling->left) && !isRed(sibling->right)) {
+                    sibling->color = RED;
+                    node = parent;
+                    parent = node->parent;
+                } else {
+                    if (!isRed(sibling->left)) {
+                        sibling->right->color = BLACK;
+                        sibling->color = RED;
+                        rotateLeft(sibling);
+                        sibling = parent->left;
+                    }
+                    sibling->color = parent->color;
+                    parent->color = BLACK;
+                    sibling->left->color = BLACK;
+                    rotateRight(parent);
+                    node = root;
+                    break;
+                }
             }
-
-            replace->left = current->left;
-            current->left->parent = replace;
-
-            node = replace;
-            color = node->color;
-            child = node->right;
-        } else {
-            node = current;
-            color = node->color;
-            child = (node->left != nullptr) ? node->left : node->right;
         }
+        if (node != nullptr) {
+            node->color = BLACK;
+        }
+    }
 
-        if (child != nullptr) {
-            child->parent = node->parent;
+    void doErase(RbNode *current) noexcept {
+        if (current->tree != this) { // 不在本树中
+            return;
+        }
+        if (current == leftmost) {
+            leftmost = successor(current);
         }
 
-        if (node == root) {
-            root = child;
-        } else if (node->parent->left == node) {
-            node->parent->left = child;
+        RbNode *child = nullptr;
+        RbNode *childParent = nullptr;
+        RbColor color = current->color;
+
+        if (current->left == nullptr) {
+            child = current->right;
+            childParent = current->parent;
+            transplant(current, current->right);
+        } else if (current->right == nullptr) {
+            child = current->left;
+            childParent = current->parent;
+            transplant(current, current->left);
         } else {
-            node->parent->right = child;
+            RbNode *replace = minimum(current->right);
+            color = replace->color;
+            child = replace->right;
+            if (replace->parent == current) {
+                childParent = replace;
+            } else {
+                childParent = replace->parent;
+                transplant(replace, replace->right);
+                replace->right = current->right;
+                replace->right->parent = replace;
+            }
+            transplant(current, replace);
+            replace->left = current->left;
+            replace->left->parent = replace;
+            replace->color = current->color;
         }
 
-        if (color == BLACK && root) {
-            fixViolation(child ? child : node->parent);
+        if (color == BLACK) {
+            fixErase(child, childParent);
         }
-    }
 
-    RbNode *getFront() const noexcept {
-        RbNode *current = root;
-        while (current->left != nullptr) {
-            current = current->left;
-        }
-        return current;
+        current->left = nullptr;
+        current->right = nullptr;
+        current->parent = nullptr;
+        current->tree = nullptr;
+        --count;
     }
 
-    RbNode *getBack() const noexcept {
+    template <class Key>
+    RbNode *doLowerBound(Key const &key) const noexcept {
         RbNode *current = root;
-        while (current->right != nullptr) {
-            current = current->right;
+        RbNode *result = nullptr;
+        while (current != nullptr) {
+            if (comp(static_cast<Value &>(*current), key)) {
+                current = current->right;
+            } else {
+                result = current;
+                current = current->left;
+            }
         }
-        return current;
+        return result;
     }
 
     template <class Visitor>
@@ -298,40 +362,98 @@ private:
             return;
         }
 
-        traversalInorder(node->left, visitor);
-        visitor(node);
+        doTraversalInorder(node->left, visitor);
+        visitor(static_cast<Value &>(*node));
         doTraversalInorder(node->right, visitor);
     }
 
 public:
-    RbTree() noexcept : root(nullptr) {}
+    RbTree() noexcept : root(nullptr), leftmost(nullptr), count(0) {}
 
     explicit RbTree(Compare comp) noexcept(noexcept(Compare(comp)))
         : root(nullptr),
+          leftmost(nullptr),
+          count(0),
           comp(comp) {}
 
     RbTree(RbTree &&) = delete;
 
-    ~RbTree() noexcept {}
+    ~RbTree() noexcept {
+        clear();
+    }
 
     void insert(Value &value) noexcept {
         doInsert(&static_cast<RbNode &>(value));
     }
 
+    /**
+     * @brief 摘除节点; 节点不在本树中时什么也不做
+     */
     void erase(Value &value) noexcept {
         doErase(&static_cast<RbNode &>(value));
     }
 
+    /**
+     * @brief 摘除全部节点 (不会析构它们)
+     */
+    void clear() noexcept {
+        while (root != nullptr) {
+            doErase(leftmost);
+        }
+    }
+
     bool empty() const noexcept {
         return root == nullptr;
     }
 
+    std::size_t size() const noexcept {
+        return count;
+    }
+
+    /**
+     * @brief 最小的节点, O(1); 树不能为空
+     */
     Value &front() const noexcept {
-        return static_cast<Value &>(*getFront());
+        return static_cast<Value &>(*leftmost);
     }
 
     Value &back() const noexcept {
-        return static_cast<Value &>(*getBack());
+        return static_cast<Value &>(*maximum(root));
+    }
+
+    /**
+     * @brief 第一个不小于 key 的节点, 没有则返回 nullptr
+     * @tparam Key 需要满足 comp(Value, Key)
+     */
+    template <class Key>
+    Value *lowerBound(Key const &key) const noexcept {
+        RbNode *node = doLowerBound(key);
+        return node ? &static_cast<Value &>(*node) : nullptr;
+    }
+
+    /**
+     * @brief 查找与 key 等价的第一个节点, 没有则返回 nullptr
+     * @tparam Key 需要满足 comp(Value, Key) 与 comp(Key, Value)
+     */
+    template <class Key>
+    Value *find(Key const &key) const noexcept {
+        RbNode *node = doLowerBound(key);
+        if (node == nullptr || comp(key, static_cast<Value &>(*node))) {
+            return nullptr;
+        }
+        return &static_cast<Value &>(*node);
+    }
+
+    /**
+     * @brief 中序的下一个节点, 没有则返回 nullptr
+     */
+    Value *next(Value &value) const noexcept {
+        RbNode *node = successor(&static_cast<RbNode &>(value));
+        return node ? &static_cast<Value &>(*node) : nullptr;
+    }
+
+    bool contains(Value &value) const noexcept {
+        return static_cast<RbNode &>(value).tree == this;
     }
 
     template <class Visitor>
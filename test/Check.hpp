@@ -0,0 +1,24 @@
+#pragma once
+/**
+ * @brief 测试小工具 (无依赖): 不用 assert, Release 构建 (NDEBUG) 下也照样检查
+ *
+ * 用法:
+ *     HX_CHECK(value == 42);
+ * 失败时打印位置与表达式并以 1 退出, 交给 ctest 判定.
+ */
+#ifndef _HX_TEST_CHECK_H_
+#define _HX_TEST_CHECK_H_
+
+#include <cstdio>
+#include <cstdlib>
+
+#define HX_CHECK(cond)                                                         \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            std::fprintf(stderr, "%s:%d: HX_CHECK(%s) failed\n",               \
+                         __FILE__, __LINE__, #cond);                           \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (0)
+
+#endif // !_HX_TEST_CHECK_H_
@@ -0,0 +1,57 @@
+/**
+ * @brief AsyncReader: 空行与 EOF 要分得开 (空行为空串, EOF 为 std::nullopt),
+ *        最后一行没有行尾也照样返回; readUntil 同理
+ */
+#include <optional>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/AsyncFile.hpp"
+#include "HX/AsyncStream.hpp"
+#include "Check.hpp"
+
+HX::Task<void> testLines(HX::AsyncFile &file) {
+    HX::AsyncReader reader(file);
+    auto first = co_await reader.readLine();
+    HX_CHECK(first && *first == "GET / HTTP/1.1");
+    auto blank = co_await reader.readLine();
+    HX_CHECK(blank && blank->empty());
+    auto last = co_await reader.readLine();
+    HX_CHECK(last && *last == "tail");
+    auto eof = co_await reader.readLine();
+    HX_CHECK(!eof);
+}
+
+HX::Task<void> testUntil(HX::AsyncFile &file) {
+    HX::AsyncReader reader(file);
+    auto field = co_await reader.readUntil(";");
+    HX_CHECK(field && *field == "a;");
+    auto empty = co_await reader.readUntil(";");
+    HX_CHECK(empty && *empty == ";");
+    auto rest = co_await reader.readUntil(";");
+    HX_CHECK(rest && *rest == "b");
+    auto eof = co_await reader.readUntil(";");
+    HX_CHECK(!eof);
+}
+
+/**
+ * @brief 写入 data 后关闭写端, 返回读端
+ */
+int feed(std::string_view data) {
+    int sv[2];
+    HX_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) == 0);
+    HX_CHECK(::write(sv[1], data.data(), data.size()) == (ssize_t)data.size());
+    ::close(sv[1]);
+    return sv[0];
+}
+
+int main() {
+    HX::AsyncLoop loop;
+    HX::AsyncFile lines(feed("GET / HTTP/1.1\r\n\r\ntail"), true);
+    HX::run_task(loop, testLines(lines));
+    HX::AsyncFile fields(feed("a;;b"), true);
+    HX::run_task(loop, testUntil(fields));
+    return 0;
+}
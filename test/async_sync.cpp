@@ -0,0 +1,83 @@
+/**
+ * @brief AsyncMutex / AsyncSemaphore / AsyncManualResetEvent / AsyncLatch (单线程):
+ *        互斥与先来先得、名额上限、事件的 set/reset、门闩倒数
+ */
+#include <chrono>
+#include <vector>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/AsyncSync.hpp"
+#include "HX/WhenAll.hpp"
+#include "Check.hpp"
+
+using namespace std::chrono_literals;
+
+HX::AsyncMutex g_mutex;
+bool g_inside = false;
+std::vector<int> g_order;
+
+HX::Task<void> critical(int id) {
+    auto guard = co_await g_mutex.scopedLock();
+    HX_CHECK(!g_inside);
+    g_inside = true;
+    co_await HX::TimerLoop::sleep_for(1ms); // 持锁挂起, 别人只能等
+    g_order.push_back(id);
+    g_inside = false;
+}
+
+HX::AsyncSemaphore g_semaphore(2);
+int g_holders = 0;
+int g_peak = 0;
+
+HX::Task<void> limited() {
+    co_await g_semaphore.acquire();
+    g_peak = std::max(g_peak, ++g_holders);
+    co_await HX::TimerLoop::sleep_for(1ms);
+    --g_holders;
+    g_semaphore.release();
+}
+
+HX::Task<int> waitEvent(HX::AsyncManualResetEvent &event, int v) {
+    co_await event.wait();
+    co_return v;
+}
+
+HX::Task<void> setLater(HX::AsyncManualResetEvent &event) {
+    co_await HX::TimerLoop::sleep_for(1ms);
+    event.set();
+}
+
+HX::Task<void> waitLatch(HX::AsyncLatch &latch) {
+    co_await latch.wait();
+}
+
+HX::Task<void> countDownLater(HX::AsyncLatch &latch) {
+    co_await HX::TimerLoop::sleep_for(1ms);
+    latch.countDown();
+}
+
+HX::Task<void> test() {
+    co_await HX::when_all(critical(0), critical(1), critical(2));
+    HX_CHECK((g_order == std::vector<int> {0, 1, 2})); // 按到达顺序交锁
+    HX_CHECK(g_mutex.tryLock());
+    g_mutex.unlock();
+
+    co_await HX::when_all(limited(), limited(), limited(), limited(), limited());
+    HX_CHECK(g_peak == 2 && g_semaphore.available() == 2);
+
+    HX::AsyncManualResetEvent event;
+    auto [a, b, _] = co_await HX::when_all(waitEvent(event, 1), waitEvent(event, 2), setLater(event));
+    HX_CHECK(a == 1 && b == 2 && event.isSet());
+    event.reset();
+    HX_CHECK(!event.isSet());
+
+    HX::AsyncLatch latch(2);
+    co_await HX::when_all(waitLatch(latch), countDownLater(latch), countDownLater(latch));
+    HX_CHECK(latch.tryWait());
+}
+
+int main() {
+    HX::AsyncLoop loop;
+    HX::run_task(loop, test());
+    return 0;
+}
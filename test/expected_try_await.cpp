@@ -0,0 +1,44 @@
+/**
+ * @brief ExpectedTask 与 try_await: 成功时取得值; 出错时错误沿链直接交给最外层, 中间层不再恢复
+ */
+#include <expected>
+#include <system_error>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/Expected.hpp"
+#include "Check.hpp"
+
+int g_resumed = 0; // 中间层在 try_await 之后继续执行的次数
+
+HX::ExpectedTask<int> leaf(bool fail) {
+    if (fail) {
+        co_return std::unexpected(std::make_error_code(std::errc::connection_reset));
+    }
+    co_return 1;
+}
+
+HX::ExpectedTask<int> middle(bool fail) {
+    int v = co_await HX::try_await(leaf(fail));
+    ++g_resumed;
+    co_return v + 1;
+}
+
+HX::ExpectedTask<int> top(bool fail) {
+    int v = co_await HX::try_await(middle(fail));
+    co_return v + 1;
+}
+
+HX::Task<void> test() {
+    auto ok = co_await top(false);
+    HX_CHECK(ok && *ok == 3 && g_resumed == 1);
+
+    auto err = co_await top(true);
+    HX_CHECK(!err && err.error() == std::errc::connection_reset);
+    HX_CHECK(g_resumed == 1);
+}
+
+int main() {
+    HX::AsyncLoop loop;
+    HX::run_task(loop, test());
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @brief Generator: 按需运行、嵌套 elements_of、异常从迭代处抛出、提前结束时销毁帧
+ */
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "HX/Generator.hpp"
+#include "Check.hpp"
+
+int g_live = 0; // 还活着的 Guard 个数
+
+struct Guard {
+    Guard() {
+        ++g_live;
+    }
+
+    ~Guard() {
+        --g_live;
+    }
+};
+
+HX::Generator<int> range(int begin, int end) {
+    Guard guard;
+    for (int i = begin; i < end; ++i) {
+        co_yield i;
+    }
+}
+
+HX::Generator<int> nested() {
+    co_yield 0;
+    co_yield HX::elements_of(range(1, 3));
+    co_yield HX::elements_of(range(3, 3)); // 空的子生成器
+    co_yield 3;
+}
+
+HX::Generator<int> failing() {
+    co_yield 1;
+    throw std::runtime_error("fail");
+}
+
+HX::Generator<int> failingNested() {
+    co_yield HX::elements_of(failing());
+}
+
+HX::Generator<std::string> names() {
+    co_yield std::string("moved");
+}
+
+int main() {
+    std::vector<int> values;
+    for (int v : nested()) {
+        values.push_back(v);
+    }
+    HX_CHECK((values == std::vector<int> {0, 1, 2, 3}));
+
+    for (int v : range(0, 100)) { // 提前跳出: 帧连同其中的局部变量一起销毁
+        if (v == 3) {
+            break;
+        }
+    }
+    HX_CHECK(g_live == 0);
+
+    for (auto make : {failing, failingNested}) {
+        bool threw = false;
+        values.clear();
+        try {
+            for (int v : make()) {
+                values.push_back(v);
+            }
+        } catch (std::runtime_error const &) {
+            threw = true;
+        }
+        HX_CHECK(threw && values == std::vector<int> {1});
+    }
+
+    for (auto &&name : names()) { // 解引用得到 co_yield 的对象本身, 可以移走
+        std::string taken = std::move(name);
+        HX_CHECK(taken == "moved");
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @brief 连接上的错误只结束那一个连接: 客户端在服务端写到一半时重置连接 (RST),
+ *        或关掉 socketpair 的另一端 (EPIPE), 服务端的 handler 抛出异常后进程照常运行, 继续接受新连接
+ */
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HX/ReactorPool.hpp"
+#include "Check.hpp"
+
+std::atomic<int> g_finished {0}; // handler 的帧已销毁 (正常结束或抛出)
+
+struct CountOnExit {
+    ~CountOnExit() {
+        ++g_finished;
+    }
+};
+
+/**
+ * @brief 一直写, 直到对端出错
+ */
+HX::Task<void> flood(HX::AsyncFile file) {
+    CountOnExit exit;
+    std::string chunk(64 * 1024, 'x');
+    while (true) {
+        co_await file.writeAll(chunk);
+    }
+}
+
+int freePort() {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct ::sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+    ::bind(fd, (struct ::sockaddr *)&addr, sizeof(addr));
+    ::socklen_t len = sizeof(addr);
+    ::getsockname(fd, (struct ::sockaddr *)&addr, &len);
+    ::close(fd);
+    return ::ntohs(addr.sin_port);
+}
+
+/**
+ * @brief 连上 port, 读到一些数据后发 RST 断开
+ */
+void connectAndReset(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct ::sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = ::htons((std::uint16_t)port);
+    addr.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+    HX_CHECK(::connect(fd, (struct ::sockaddr *)&addr, sizeof(addr)) == 0);
+    char buf[4096];
+    HX_CHECK(::read(fd, buf, sizeof(buf)) > 0);
+    struct ::linger linger {1, 0}; // close 时直接发 RST
+    ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    ::close(fd);
+}
+
+void waitFinished(int n) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (g_finished < n && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    HX_CHECK(g_finished == n);
+}
+
+int main() {
+    HX::ReactorPool pool(1, false);
+
+    int port = freePort();
+    pool.listen("127.0.0.1", port, flood);
+    connectAndReset(port);
+    waitFinished(1);
+    connectAndReset(port); // 还在监听
+    waitFinished(2);
+
+    int sv[2];
+    HX_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) == 0);
+    pool.spawn(0, HX::AsyncFile(sv[0], true), flood);
+    char buf[4096];
+    while (::read(sv[1], buf, sizeof(buf)) <= 0) {
+    }
+    ::close(sv[1]); // 服务端接着写会得到 EPIPE (反应堆线程屏蔽了 SIGPIPE)
+    waitFinished(3);
+
+    pool.spawn(0, []() -> HX::Task<void> { // 不是连接错误的异常: 打印出来, 进程照常运行
+        CountOnExit exit;
+        throw std::runtime_error("expected: handler failed");
+        co_return;
+    }());
+    waitFinished(4);
+    return 0;
+}
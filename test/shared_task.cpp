@@ -0,0 +1,59 @@
+/**
+ * @brief SharedTask: 多个等待者只运行一次、都拿到同一个结果; 异常交给每个等待者; 结束后再等直接返回
+ */
+#include <chrono>
+#include <stdexcept>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/SharedTask.hpp"
+#include "HX/WhenAll.hpp"
+#include "Check.hpp"
+
+using namespace std::chrono_literals;
+
+int g_runs = 0;
+
+HX::SharedTask<int> lookup() {
+    ++g_runs;
+    co_await HX::TimerLoop::sleep_for(2ms);
+    co_return 42;
+}
+
+HX::SharedTask<int> broken() {
+    co_await HX::TimerLoop::sleep_for(1ms);
+    throw std::runtime_error("fail");
+}
+
+HX::Task<int> get(HX::SharedTask<int> shared) {
+    co_return co_await shared;
+}
+
+HX::Task<bool> getFails(HX::SharedTask<int> shared) {
+    try {
+        co_await shared;
+    } catch (std::runtime_error const &) {
+        co_return true;
+    }
+    co_return false;
+}
+
+HX::Task<void> test() {
+    auto shared = lookup();
+    auto [a, b, c] = co_await HX::when_all(get(shared), get(shared), get(shared));
+    HX_CHECK(a == 42 && b == 42 && c == 42 && g_runs == 1);
+    HX_CHECK(shared.isDone());
+    int again = co_await shared; // 直接拿缓存
+    HX_CHECK(again == 42 && g_runs == 1);
+
+    auto failed = broken();
+    auto [x, y] = co_await HX::when_all(getFails(failed), getFails(failed));
+    HX_CHECK(x && y);
+    bool rethrown = co_await getFails(failed);
+    HX_CHECK(rethrown);
+}
+
+int main() {
+    HX::AsyncLoop loop;
+    HX::run_task(loop, test());
+    return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * @brief TaskGroup: 按 spawn 顺序返回结果、同时运行数不超上限;
+ *        一个子任务抛异常时取消其余的并在 join 时重新抛出; 父令牌取消时 join 抛 operation_canceled
+ */
+#include <chrono>
+#include <stdexcept>
+#include <stop_token>
+#include <system_error>
+#include <vector>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/TaskGroup.hpp"
+#include "Check.hpp"
+
+using namespace std::chrono_literals;
+
+int g_running = 0;
+int g_peak = 0;
+int g_cancelled = 0;
+
+HX::Task<int> work(int v, std::chrono::milliseconds delay) {
+    g_peak = std::max(g_peak, ++g_running);
+    co_await HX::TimerLoop::sleep_for(delay); // 被取消时提前返回
+    auto token = co_await HX::current_stop_token();
+    --g_running;
+    if (token.stop_requested()) {
+        ++g_cancelled;
+    }
+    co_return v;
+}
+
+HX::Task<int> fail() {
+    co_await HX::TimerLoop::sleep_for(1ms);
+    throw std::runtime_error("fail");
+}
+
+HX::Task<void> test() {
+    HX::TaskGroup<int> group(2);
+    for (int i = 0; i < 6; ++i) {
+        group.spawn(work(i, std::chrono::milliseconds(6 - i)));
+    }
+    auto results = co_await group.join();
+    HX_CHECK((results == std::vector<int> {0, 1, 2, 3, 4, 5}));
+    HX_CHECK(g_peak == 2 && g_running == 0);
+
+    HX::TaskGroup<int> failing;
+    failing.spawn(work(0, 1h));
+    failing.spawn(fail());
+    bool threw = false;
+    try {
+        co_await failing.join();
+    } catch (std::runtime_error const &) {
+        threw = true;
+    }
+    HX_CHECK(threw && g_cancelled == 1);
+
+    std::stop_source parent;
+    HX::TaskGroup<int> cancelled(1, parent.get_token());
+    cancelled.spawn(work(0, 1h));
+    cancelled.spawn(work(1, 1h)); // 排队中, 被取消后不再运行
+    HX::TimerLoop::getLoop().addTask([](std::stop_source &source) -> HX::DetachedTask {
+        co_await HX::TimerLoop::sleep_for(1ms);
+        source.request_stop();
+    }(parent)._coroutine);
+    bool canceled = false;
+    try {
+        co_await cancelled.join();
+    } catch (std::system_error const &e) {
+        canceled = e.code() == std::errc::operation_canceled;
+    }
+    HX_CHECK(canceled && g_cancelled == 2);
+}
+
+int main() {
+    HX::AsyncLoop loop;
+    HX::run_task(loop, test());
+    return 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * @brief 以分层时间轮为后端 (HX_TIMER_WHEEL=1) 编译并运行 TimerLoop:
+ *        计时器按到期顺序触发且不会提前, 跨过多层时间轮的长计时器也能到期, 取消时提前返回
+ */
+#define HX_TIMER_WHEEL 1
+
+#include <chrono>
+#include <vector>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/WhenAll.hpp"
+#include "HX/WhenAny.hpp"
+#include "Check.hpp"
+
+using namespace std::chrono_literals;
+
+std::vector<int> g_order;
+
+HX::Task<void> sleeper(int id, std::chrono::milliseconds duration) {
+    auto start = std::chrono::system_clock::now();
+    co_await HX::TimerLoop::sleep_for(duration);
+    HX_CHECK(std::chrono::system_clock::now() - start >= duration); // 向上取整到 tick, 不会提前
+    g_order.push_back(id);
+}
+
+HX::Task<int> forever() {
+    co_await HX::TimerLoop::sleep_for(24h);
+    co_return 0;
+}
+
+HX::Task<int> soon() {
+    co_await HX::TimerLoop::sleep_for(2ms);
+    co_return 1;
+}
+
+HX::Task<void> test() {
+    co_await HX::when_all(sleeper(3, 30ms), sleeper(1, 1ms), sleeper(2, 10ms), sleeper(4, 300ms));
+    HX_CHECK((g_order == std::vector<int> {1, 2, 3, 4}));
+
+    auto start = std::chrono::steady_clock::now();
+    auto res = co_await HX::when_any(forever(), soon()); // 24h 的计时器挂在高层, 被取消后摘掉
+    HX_CHECK(res.index() == 1);
+    HX_CHECK(std::chrono::steady_clock::now() - start < 1s);
+}
+
+int main() {
+    HX::AsyncLoop loop;
+    HX::run_task(loop, test());
+    HX_CHECK(!HX::TimerLoop::getLoop().hasTimer());
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * @brief UringRecvStream 与缓冲环: 一个流攒着数据不取, 把环里的缓冲占光;
+ *        这时另一个流等数据不能空转 (-ENOBUFS 后每次重挂立即又完成), 而是等缓冲归还;
+ *        前一个流析构时要把攒下的缓冲全部还回环里, 另一个流随即收到数据.
+ *        io_uring 或缓冲环不可用时直接通过
+ */
+#define HX_USE_IO_URING 1
+
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HX/AsyncLoop.hpp"
+#include "Check.hpp"
+
+using namespace std::chrono_literals;
+
+std::chrono::microseconds cpuTime() {
+    struct ::rusage usage;
+    ::getrusage(RUSAGE_THREAD, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+         + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+bool g_received = false;
+
+HX::DetachedTask receive(HX::UringRecvStream &stream) {
+    auto data = co_await stream.next();
+    g_received = std::string_view(data.data(), data.size()) == "hello";
+}
+
+HX::Task<void> test(int hog, int quiet, int quietPeer) {
+    auto hogStream = std::make_unique<HX::UringRecvStream>(hog);
+    auto first = co_await hogStream->next(); // 之后不再取, multishot 把缓冲一块块占掉
+    HX_CHECK(!first.empty());
+    co_await HX::TimerLoop::sleep_for(100ms);
+
+    HX::UringRecvStream quietStream(quiet);
+    HX_CHECK(::write(quietPeer, "hello", 5) == 5);
+    HX::TimerLoop::getLoop().addTask(receive(quietStream)._coroutine);
+    auto before = cpuTime();
+    co_await HX::TimerLoop::sleep_for(50ms);
+    HX_CHECK(!g_received);           // 环里没有缓冲
+    HX_CHECK(cpuTime() - before < 25ms); // 也没有空转
+
+    hogStream.reset(); // 攒下的缓冲还回环里
+    for (int i = 0; i < 100 && !g_received; ++i) {
+        co_await HX::TimerLoop::sleep_for(1ms);
+    }
+    HX_CHECK(g_received);
+}
+
+int main() {
+    if (!HX::UringLoop::isEnabled() || !HX::UringLoop::get().recvBuffers()) {
+        return 0;
+    }
+    int hog[2], quiet[2];
+    HX_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, hog) == 0);
+    HX_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, quiet) == 0);
+    std::thread writer([fd = hog[1]] { // 写到对端关闭为止, 远多于环里的缓冲
+        static char buf[64 * 1024] {};
+        while (::send(fd, buf, sizeof(buf), MSG_NOSIGNAL) > 0) {
+        }
+    });
+    HX::AsyncLoop loop;
+    HX::run_task(loop, test(hog[0], quiet[0], quiet[1]));
+    ::shutdown(hog[0], SHUT_RDWR);
+    writer.join();
+    for (int fd : {hog[0], hog[1], quiet[0], quiet[1]}) {
+        ::close(fd);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * @brief when_all / when_any: 成功、异常、取消三条路径;
+ *        异常时已完成的子任务结果要被销毁 (用计数类型检查), 空 range 的 when_any 直接报错
+ */
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/WhenAll.hpp"
+#include "HX/WhenAny.hpp"
+#include "Check.hpp"
+
+using namespace std::chrono_literals;
+
+int g_live = 0; // 还活着的 Counted 个数
+
+struct Counted {
+    explicit Counted(int value) : _value(value) {
+        ++g_live;
+    }
+
+    Counted(Counted &&that) noexcept : _value(that._value) {
+        ++g_live;
+    }
+
+    ~Counted() {
+        --g_live;
+    }
+
+    int _value;
+};
+
+HX::Task<Counted> makeCounted(int value, std::chrono::milliseconds delay) {
+    co_await HX::TimerLoop::sleep_for(delay);
+    co_return Counted(value);
+}
+
+HX::Task<int> value(int v, std::chrono::milliseconds delay) {
+    co_await HX::TimerLoop::sleep_for(delay);
+    co_return v;
+}
+
+HX::Task<int> fail(std::chrono::milliseconds delay) {
+    co_await HX::TimerLoop::sleep_for(delay);
+    throw std::runtime_error("fail");
+}
+
+/**
+ * @brief 被取消前一直睡; 记下是否看到了取消
+ */
+HX::Task<int> sleeper(bool &cancelled) {
+    co_await HX::TimerLoop::sleep_for(1h);
+    auto token = co_await HX::current_stop_token();
+    cancelled = token.stop_requested();
+    co_return -1;
+}
+
+HX::Task<void> testWhenAll() {
+    auto [a, b] = co_await HX::when_all(value(1, 2ms), value(2, 1ms));
+    HX_CHECK(a == 1 && b == 2);
+
+    std::vector<HX::Task<Counted>> tasks;
+    for (int i = 0; i < 3; ++i) {
+        tasks.push_back(makeCounted(i, 1ms));
+    }
+    auto res = co_await HX::when_all(std::move(tasks));
+    HX_CHECK(res.size() == 3 && res[2]._value == 2);
+    res.clear();
+    HX_CHECK(g_live == 0);
+
+    bool threw = false;
+    try { // 先完成的那个结果不能泄漏
+        co_await HX::when_all(makeCounted(1, 0ms), fail(1ms));
+    } catch (std::runtime_error const &) {
+        threw = true;
+    }
+    HX_CHECK(threw && g_live == 0);
+
+    threw = false;
+    std::vector<HX::Task<Counted>> some;
+    some.push_back(makeCounted(1, 0ms));
+    some.push_back([]() -> HX::Task<Counted> {
+        co_await HX::TimerLoop::sleep_for(1ms);
+        throw std::runtime_error("fail");
+    }());
+    some.push_back(makeCounted(3, 2ms));
+    try {
+        co_await HX::when_all(std::move(some));
+    } catch (std::runtime_error const &) {
+        threw = true;
+    }
+    HX_CHECK(threw && g_live == 0);
+}
+
+HX::Task<void> testWhenAny() {
+    bool cancelled = false;
+    auto first = co_await HX::when_any(value(7, 1ms), sleeper(cancelled));
+    HX_CHECK(first.index() == 0 && std::get<0>(first) == 7);
+    co_await HX::TimerLoop::sleep_for(1ms); // 输家在下一轮观察到取消
+    HX_CHECK(cancelled);
+
+    bool threw = false;
+    try {
+        co_await HX::when_any(fail(0ms), value(1, 5ms));
+    } catch (std::runtime_error const &) {
+        threw = true;
+    }
+    HX_CHECK(threw);
+
+    std::vector<HX::Task<int>> tasks;
+    tasks.push_back(value(1, 3ms));
+    tasks.push_back(value(2, 1ms));
+    auto [index, result] = co_await HX::when_any(std::move(tasks));
+    HX_CHECK(index == 1 && result == 2);
+
+    threw = false;
+    try {
+        co_await HX::when_any(std::vector<HX::Task<int>> {});
+    } catch (std::invalid_argument const &) {
+        threw = true;
+    }
+    HX_CHECK(threw);
+}
+
+int main() {
+    HX::AsyncLoop loop;
+    HX::run_task(loop, testWhenAll());
+    HX::run_task(loop, testWhenAny());
+    return 0;
+}
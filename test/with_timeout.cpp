@@ -0,0 +1,56 @@
+/**
+ * @brief with_timeout: 按时完成返回结果; 超时返回 std::nullopt, 不论 task 是正常返回
+ *        还是像 I/O 原语那样被取消时抛 operation_canceled; 其它异常原样抛出
+ */
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HX/AsyncLoop.hpp"
+#include "HX/AsyncFile.hpp"
+#include "HX/Timeout.hpp"
+#include "Check.hpp"
+
+using namespace std::chrono_literals;
+
+HX::Task<int> value(int v, std::chrono::milliseconds delay) {
+    co_await HX::TimerLoop::sleep_for(delay);
+    co_return v;
+}
+
+HX::Task<int> fail() {
+    co_await HX::TimerLoop::sleep_for(1ms);
+    throw std::runtime_error("fail");
+}
+
+HX::Task<void> test(HX::AsyncFile &full) {
+    auto ok = co_await HX::with_timeout(value(1, 1ms), 1s);
+    HX_CHECK(ok && *ok == 1);
+
+    auto slow = co_await HX::with_timeout(value(2, 1h), 5ms); // 睡眠被取消后正常返回
+    HX_CHECK(!slow);
+
+    std::string big(8 << 20, 'x'); // 对端不读, 写不完
+    auto write = co_await HX::with_timeout(full.writeAll(big), 5ms); // 被取消时抛 operation_canceled
+    HX_CHECK(!write);
+
+    bool threw = false;
+    try {
+        co_await HX::with_timeout(fail(), 1s);
+    } catch (std::runtime_error const &) {
+        threw = true;
+    }
+    HX_CHECK(threw);
+}
+
+int main() {
+    int sv[2];
+    HX_CHECK(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) == 0);
+    HX::AsyncLoop loop;
+    HX::AsyncFile full(sv[0], true);
+    HX::run_task(loop, test(full));
+    ::close(sv[1]);
+    return 0;
+}